@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : clock_gov.h
+  * @brief          : Header for clock_gov.c file.
+  *                   Bus clock scaling between report traffic and idle
+  *                   intervals. The PLL stays at 48 MHz for the USB clock,
+  *                   only the AHB / APB prescalers are changed.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CLOCK_GOV_H
+#define __CLOCK_GOV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  CLOCK_GOV_FULL = 0,   /* HCLK 48 MHz, APB1 24 MHz, APB2 48 MHz */
+  CLOCK_GOV_IDLE,       /* HCLK 12 MHz, APB1 12 MHz, APB2 12 MHz */
+  CLOCK_GOV_STATE_NB
+} ClockGov_StateTypeDef;
+
+typedef struct
+{
+  uint32_t entries[CLOCK_GOV_STATE_NB];      /* transitions into each state    */
+  uint32_t residency_ms[CLOCK_GOV_STATE_NB]; /* time spent in each state       */
+  uint32_t last_cycles;                      /* core cycles of last transition */
+  uint32_t max_cycles;                       /* worst transition               */
+  uint32_t saved_uAs;                        /* estimated charge saved in idle */
+} ClockGov_StatsTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+/* Time without report traffic before the bus clocks are lowered */
+#ifndef CLOCK_GOV_IDLE_TIMEOUT_MS
+#define CLOCK_GOV_IDLE_TIMEOUT_MS        100U
+#endif
+
+/* Supply current estimate of each state, used for saved_uAs only.
+   To be calibrated against a measurement on the board. */
+#ifndef CLOCK_GOV_FULL_UA
+#define CLOCK_GOV_FULL_UA                24000U
+#endif
+#ifndef CLOCK_GOV_IDLE_UA
+#define CLOCK_GOV_IDLE_UA                10000U
+#endif
+
+/* Hold reasons, full speed is kept while any of them is set */
+#define CLOCK_GOV_HOLD_HAPTIC            0x01U   /* TIM1 carrier follows PCLK2 */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void ClockGov_Init(void);
+void ClockGov_Activity(void);
+void ClockGov_Suspend(void);
+void ClockGov_Hold(uint32_t reason);
+void ClockGov_Release(uint32_t reason);
+void ClockGov_Tick(void);
+void ClockGov_Process(void);
+ClockGov_StateTypeDef ClockGov_GetState(void);
+void ClockGov_GetStats(ClockGov_StatsTypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLOCK_GOV_H */
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : event.h
+  * @brief          : Header for event.c file.
+  *                   Cooperative main loop: interrupts post pending work as
+  *                   bits of a bitmap, the loop runs the matching handlers
+  *                   in bit order and sleeps when nothing is pending.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __EVENT_H
+#define __EVENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*Event_HandlerTypeDef)(void);
+
+/* Exported constants --------------------------------------------------------*/
+/* Event numbers, lowest number is dispatched first */
+#define EVENT_CLOCK                      0U   /* bus clock state to update   */
+#define EVENT_USB_REPORT                 1U   /* HID output report received  */
+#define EVENT_HAPTIC                     2U   /* haptic retrigger is due     */
+#define EVENT_VENDOR                     3U   /* vendor request or telemetry */
+#define EVENT_DFU                        4U   /* DFU block to program        */
+
+#define EVENT_NB                         32U
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Event_Register(uint32_t event, Event_HandlerTypeDef handler);
+void Event_Post(uint32_t event);
+void Event_Dispatch(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EVENT_H */
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file           : fault.h
+  * @brief          : Header for fault.c file.
+  *                   Fault capture into RAM kept across reset and post-mortem
+  *                   readout through the vendor feature report.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FAULT_H
+#define __FAULT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t magic;
+  uint32_t count;        /* faults since the record was last cleared */
+  uint32_t type;         /* FAULT_TYPE_xxx of the last fault        */
+  uint32_t exc_return;
+  uint32_t r0;           /* exception frame */
+  uint32_t r1;
+  uint32_t r2;
+  uint32_t r3;
+  uint32_t r12;
+  uint32_t lr;
+  uint32_t pc;
+  uint32_t xpsr;
+  uint32_t cfsr;
+  uint32_t hfsr;
+  uint32_t mmfar;
+  uint32_t bfar;
+  uint32_t sp;           /* stack pointer before the exception */
+  uint32_t stack[8];     /* words above the exception frame    */
+  uint32_t sum;          /* sum of the words above             */
+} Fault_RecordTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+/* The linker is given 0x4F80 bytes of RAM in the project, the record lives in
+   the 128 bytes left above so that startup code does not clear it. */
+#define FAULT_RECORD_ADDR                0x20004F80U
+
+#define FAULT_TYPE_HARD                  1U
+#define FAULT_TYPE_MEMMANAGE             2U
+#define FAULT_TYPE_BUS                   3U
+#define FAULT_TYPE_USAGE                 4U
+
+/* Vendor feature report of the mouse interface:
+   ID, page, page count, watchdog reset cause, FAULT_PAGE_SIZE record bytes.
+   A SET_FEATURE selects the page returned next, FAULT_CMD_CLEAR in the
+   third byte erases the record. */
+#define FAULT_REPORT_ID                  0x0AU
+#define FAULT_REPORT_SIZE                36U
+#define FAULT_PAGE_SIZE                  32U
+#define FAULT_CMD_CLEAR                  0xC1U
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Fault_Init(void);
+void Fault_SetFeatureReport(const uint8_t *report, uint16_t len);
+uint16_t Fault_GetFeatureReport(uint8_t *report);
+const Fault_RecordTypeDef *Fault_GetRecord(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FAULT_H */
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : haptic.h
+  * @brief          : Header for haptic.c file.
+  *                   Surface Dial haptic feedback driven by the HID output
+  *                   and feature reports of the dial interface.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HAPTIC_H
+#define __HAPTIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Report ID shared by the dial input, feature and output reports */
+#define HAPTIC_REPORT_ID                 0x10U
+
+/* Output report : ID, repeat count, manual trigger, retrigger period (2) */
+#define HAPTIC_OUTPUT_REPORT_SIZE        5U
+/* Feature report: ID, dial resolution (2), repeat count, auto trigger,
+                   waveform cutoff time, retrigger period (2) */
+#define HAPTIC_FEATURE_REPORT_SIZE       8U
+
+/* Dial resolution advertised in the feature report (Logical Maximum 3600) */
+#define HAPTIC_DIAL_RESOLUTION           3600U
+
+/* Waveform ordinals, as carried by the auto / manual trigger usages */
+#define HAPTIC_WAVEFORM_NONE             0x00U
+#define HAPTIC_WAVEFORM_STOP             0x01U
+#define HAPTIC_WAVEFORM_NULL             0x02U
+#define HAPTIC_WAVEFORM_CLICK            0x03U
+#define HAPTIC_WAVEFORM_BUZZ             0x04U
+#define HAPTIC_WAVEFORM_RUMBLE           0x05U
+#define HAPTIC_WAVEFORM_PRESS            0x06U
+#define HAPTIC_WAVEFORM_RELEASE          0x07U
+
+#define HAPTIC_RETRIGGER_MAX_MS          2000U
+#define HAPTIC_CUTOFF_MAX                10U
+
+/* Envelope sample rate: one DMA transfer per TIM1 update event */
+#define HAPTIC_SAMPLE_RATE_HZ            2000U
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Haptic_Init(TIM_HandleTypeDef *htim);
+void Haptic_Play(uint8_t waveform, uint8_t repeat, uint16_t retrigger_ms);
+void Haptic_AutoTrigger(void);
+void Haptic_Tick(void);
+void Haptic_Process(void);
+
+void Haptic_OutputReport(const uint8_t *report, uint16_t len);
+void Haptic_SetFeatureReport(const uint8_t *report, uint16_t len);
+uint16_t Haptic_GetFeatureReport(uint8_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HAPTIC_H */
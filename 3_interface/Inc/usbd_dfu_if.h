@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_dfu_if.h
+  * @brief          : Header for usbd_dfu_if.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_DFU_IF_H__
+#define __USBD_DFU_IF_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_dfu.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Written in the last page of the download slot once the image is complete */
+typedef struct
+{
+  uint32_t magic;
+  uint32_t size;         /* image size, padded to a word */
+  uint32_t crc;          /* CRC unit checksum of the image */
+  uint32_t reserved;
+} DFU_RecordTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+/* The application is linked in the lower 32 KB of the flash, the upper
+   32 KB is the download slot: 31 pages of image and the record page. */
+#define DFU_SLOT_ADDR                    0x08008000U
+#define DFU_SLOT_SIZE                    0x7C00U
+#define DFU_RECORD_ADDR                  (DFU_SLOT_ADDR + DFU_SLOT_SIZE)
+#define DFU_RECORD_MAGIC                 0x44465531U   /* "DFU1" */
+
+/* Pages kept erased in front of the write pointer */
+#define DFU_ERASE_AHEAD                  FLASH_PAGE_SIZE
+
+/* Exported variables --------------------------------------------------------*/
+/** Download slot of the FS device. */
+extern USBD_DFU_MediaTypeDef USBD_DFU_fops_FS;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void DFU_Process_FS(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_DFU_IF_H__ */
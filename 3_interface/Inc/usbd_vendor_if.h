@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_vendor_if.h
+  * @brief          : Header for usbd_vendor_if.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBD_VENDOR_IF_H__
+#define __USBD_VENDOR_IF_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_vendor.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Commands, replies carry the command with VENDOR_FRAME_REPLY set */
+#define VENDOR_CMD_PING                  0x01U   /* echo of the payload           */
+#define VENDOR_CMD_GET_STATS             0x02U   /* clock governor statistics     */
+#define VENDOR_CMD_GET_FAULT             0x03U   /* retained fault record         */
+#define VENDOR_CMD_STREAM                0x04U   /* period (2, ms), 0 to stop     */
+
+/* Status byte of the replies */
+#define VENDOR_STATUS_OK                 0x00U
+#define VENDOR_STATUS_UNKNOWN            0x01U   /* command not supported */
+#define VENDOR_STATUS_BAD_LENGTH         0x02U
+#define VENDOR_STATUS_NO_DATA            0x03U   /* nothing recorded      */
+
+/* Shortest telemetry period */
+#define VENDOR_STREAM_MIN_MS             5U
+
+/* Exported variables --------------------------------------------------------*/
+/** Vendor interface callbacks of the FS device. */
+extern USBD_VENDOR_ItfTypeDef USBD_VENDOR_fops_FS;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void VENDOR_Tick_FS(void);
+void VENDOR_Process_FS(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_VENDOR_IF_H__ */
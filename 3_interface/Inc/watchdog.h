@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file           : watchdog.h
+  * @brief          : Header for watchdog.c file.
+  *                   IWDG supervisor: the watchdog is refreshed only when
+  *                   every armed subsystem has checked in since the last
+  *                   refresh.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Liveness tokens */
+#define WDG_TOKEN_MAIN                   0x01U   /* main loop dispatching      */
+#define WDG_TOKEN_USB                    0x02U   /* SOF seen, bus not suspended */
+
+/* Recorded instead of a token when Error_Handler was reached */
+#define WDG_CAUSE_ERROR                  0x80U
+
+/* Interval between two token checks, tokens must all be set within it */
+#define WDG_CHECK_MS                     50U
+
+/* Exported functions prototypes ---------------------------------------------*/
+void Watchdog_Init(IWDG_HandleTypeDef *hiwdg);
+void Watchdog_CheckIn(uint32_t token);
+void Watchdog_Disarm(uint32_t token);
+void Watchdog_Tick(void);
+void Watchdog_Panic(uint32_t cause);
+uint32_t Watchdog_GetResetCause(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WATCHDOG_H */
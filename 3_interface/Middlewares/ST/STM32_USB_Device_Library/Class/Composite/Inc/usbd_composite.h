@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    usbd_composite.h
+  * @brief   Header file for the usbd_composite.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_COMPOSITE_H
+#define __USB_COMPOSITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_COMPOSITE
+  * @brief This file is the Header file for usbd_composite.c
+  * @{
+  */
+
+
+/** @defgroup USBD_COMPOSITE_Exported_Defines
+  * @{
+  */
+#ifndef USBD_COMPOSITE_MAX_CLASSES
+#define USBD_COMPOSITE_MAX_CLASSES          4U
+#endif /* USBD_COMPOSITE_MAX_CLASSES */
+
+#ifndef USBD_COMPOSITE_CFG_DESC_SIZE
+#define USBD_COMPOSITE_CFG_DESC_SIZE        256U
+#endif /* USBD_COMPOSITE_CFG_DESC_SIZE */
+
+#define USBD_COMPOSITE_EP_NB                16U
+#define USBD_COMPOSITE_NO_CLASS             0xFFU
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_COMPOSITE_Exported_TypesDefinitions
+  * @{
+  */
+typedef struct
+{
+  USBD_ClassTypeDef   *pClass;
+  void                *pClassData;
+  void                *pUserData;
+}
+USBD_COMPOSITE_EntryTypeDef;
+
+typedef struct
+{
+  USBD_COMPOSITE_EntryTypeDef  entry[USBD_COMPOSITE_MAX_CLASSES];
+  uint8_t                      class_nb;
+  uint8_t                      ctl_class;
+  uint8_t                      itf_class[USBD_MAX_NUM_INTERFACES];
+  uint8_t                      ep_in_class[USBD_COMPOSITE_EP_NB];
+  uint8_t                      ep_out_class[USBD_COMPOSITE_EP_NB];
+  void                        *primary_data;
+  void                        *primary_user;
+  uint16_t                     cfg_len;
+  uint8_t                      cfg_desc[USBD_COMPOSITE_CFG_DESC_SIZE];
+}
+USBD_COMPOSITE_HandleTypeDef;
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_COMPOSITE_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_COMPOSITE;
+#define USBD_COMPOSITE_CLASS    &USBD_COMPOSITE
+/**
+  * @}
+  */
+
+/** @defgroup USBD_COMPOSITE_Exported_Functions
+  * @{
+  */
+uint8_t USBD_COMPOSITE_AddClass(USBD_HandleTypeDef *pdev,
+                                USBD_ClassTypeDef *pclass,
+                                void *pUserData);
+
+void *USBD_COMPOSITE_GetClassData(USBD_HandleTypeDef *pdev,
+                                  USBD_ClassTypeDef *pclass);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_COMPOSITE_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
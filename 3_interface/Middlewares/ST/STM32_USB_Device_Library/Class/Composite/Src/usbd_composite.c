@@ -0,0 +1,577 @@
+/**
+  ******************************************************************************
+  * @file    usbd_composite.c
+  * @brief   Composite class multiplexer.
+  *
+  * @verbatim
+  *
+  *          ===================================================================
+  *                                Composite Description
+  *          ===================================================================
+  *           Several classes share the device. Each class keeps its own
+  *           configuration descriptor with its final interface numbers and
+  *           endpoint addresses; USBD_COMPOSITE_AddClass walks it to fill
+  *           the interface-to-class and endpoint-to-class tables and
+  *           appends its interfaces to the device configuration descriptor.
+  *           The callbacks of the core are then routed by a table lookup.
+  *
+  *           The first class added is the primary class: its pClassData
+  *           and pUserData stay in the device handle at all times, so its
+  *           callbacks and its application API run unchanged. The context
+  *           of the other classes is swapped in around each of their
+  *           callbacks, their application API reaches it through
+  *           USBD_COMPOSITE_GetClassData.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_composite.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_COMPOSITE
+  * @brief usbd composite module
+  * @{
+  */
+
+/** @defgroup USBD_COMPOSITE_Private_Macros
+  * @{
+  */
+#define USBD_COMPOSITE_PRIMARY              0U
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_COMPOSITE_Private_FunctionPrototypes
+  * @{
+  */
+
+static uint8_t  USBD_COMPOSITE_Init(USBD_HandleTypeDef *pdev,
+                                    uint8_t cfgidx);
+
+static uint8_t  USBD_COMPOSITE_DeInit(USBD_HandleTypeDef *pdev,
+                                      uint8_t cfgidx);
+
+static uint8_t  USBD_COMPOSITE_Setup(USBD_HandleTypeDef *pdev,
+                                     USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_COMPOSITE_EP0_TxSent(USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_COMPOSITE_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_COMPOSITE_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_COMPOSITE_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_COMPOSITE_SOF(USBD_HandleTypeDef *pdev);
+
+static uint8_t  USBD_COMPOSITE_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_COMPOSITE_IsoOUTIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  *USBD_COMPOSITE_GetFSCfgDesc(uint16_t *length);
+
+static void USBD_COMPOSITE_Enter(USBD_HandleTypeDef *pdev, uint8_t idx);
+
+static void USBD_COMPOSITE_Leave(USBD_HandleTypeDef *pdev, uint8_t idx);
+/**
+  * @}
+  */
+
+/** @defgroup USBD_COMPOSITE_Private_Variables
+  * @{
+  */
+
+USBD_ClassTypeDef  USBD_COMPOSITE =
+{
+  USBD_COMPOSITE_Init,
+  USBD_COMPOSITE_DeInit,
+  USBD_COMPOSITE_Setup,
+  USBD_COMPOSITE_EP0_TxSent,
+  USBD_COMPOSITE_EP0_RxReady,
+  USBD_COMPOSITE_DataIn,
+  USBD_COMPOSITE_DataOut,
+  USBD_COMPOSITE_SOF,
+  USBD_COMPOSITE_IsoINIncomplete,
+  USBD_COMPOSITE_IsoOUTIncomplete,
+  NULL,
+  USBD_COMPOSITE_GetFSCfgDesc,
+  NULL,
+  NULL,
+};
+
+/* Single device instance (FS) */
+static USBD_COMPOSITE_HandleTypeDef hcomposite;
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_COMPOSITE_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_COMPOSITE_AddClass
+  *         Add a class to the composite device. Its interfaces and
+  *         endpoints must not overlap those of the classes already added.
+  *         Must be called before USBD_RegisterClass(pdev, &USBD_COMPOSITE).
+  * @param  pdev: device instance
+  * @param  pclass: class to add
+  * @param  pUserData: class user data (fops), NULL if registered later
+  *                    through the class own API (primary class only)
+  * @retval status
+  */
+uint8_t USBD_COMPOSITE_AddClass(USBD_HandleTypeDef *pdev,
+                                USBD_ClassTypeDef *pclass,
+                                void *pUserData)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t *desc;
+  uint16_t len;
+  uint16_t idx;
+  uint8_t num;
+  uint8_t cls = hcomp->class_nb;
+
+  if ((pclass == NULL) || (pclass->GetFSConfigDescriptor == NULL) ||
+      (cls >= USBD_COMPOSITE_MAX_CLASSES))
+  {
+    return USBD_FAIL;
+  }
+
+  if (cls == 0U)
+  {
+    (void)memset(hcomp->itf_class, USBD_COMPOSITE_NO_CLASS, sizeof(hcomp->itf_class));
+    (void)memset(hcomp->ep_in_class, USBD_COMPOSITE_NO_CLASS, sizeof(hcomp->ep_in_class));
+    (void)memset(hcomp->ep_out_class, USBD_COMPOSITE_NO_CLASS, sizeof(hcomp->ep_out_class));
+  }
+
+  desc = pclass->GetFSConfigDescriptor(&len);
+  if ((desc == NULL) || (len < USB_LEN_CFG_DESC) ||
+      ((uint32_t)hcomp->cfg_len + len - USB_LEN_CFG_DESC > USBD_COMPOSITE_CFG_DESC_SIZE))
+  {
+    return USBD_FAIL;
+  }
+
+  /* Configuration header from the primary class */
+  if (cls == 0U)
+  {
+    (void)memcpy(hcomp->cfg_desc, desc, USB_LEN_CFG_DESC);
+    hcomp->cfg_desc[4] = 0U;
+    hcomp->cfg_len = USB_LEN_CFG_DESC;
+  }
+
+  /* Map the interfaces and endpoints found in the class descriptor */
+  for (idx = USB_LEN_CFG_DESC; (idx + 2U) < len; idx += desc[idx])
+  {
+    if (desc[idx] == 0U)
+    {
+      return USBD_FAIL;
+    }
+
+    switch (desc[idx + 1U])
+    {
+      case USB_DESC_TYPE_INTERFACE:
+        num = desc[idx + 2U];
+        if ((num >= USBD_MAX_NUM_INTERFACES) ||
+            ((hcomp->itf_class[num] != USBD_COMPOSITE_NO_CLASS) && (hcomp->itf_class[num] != cls)))
+        {
+          return USBD_FAIL;
+        }
+        if (hcomp->itf_class[num] == USBD_COMPOSITE_NO_CLASS)
+        {
+          hcomp->itf_class[num] = cls;
+          hcomp->cfg_desc[4]++;
+        }
+        break;
+
+      case USB_DESC_TYPE_ENDPOINT:
+        num = desc[idx + 2U] & 0xFU;
+        if ((desc[idx + 2U] & 0x80U) != 0U)
+        {
+          hcomp->ep_in_class[num] = cls;
+        }
+        else
+        {
+          hcomp->ep_out_class[num] = cls;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  (void)memcpy(&hcomp->cfg_desc[hcomp->cfg_len], &desc[USB_LEN_CFG_DESC],
+                    len - USB_LEN_CFG_DESC);
+  hcomp->cfg_len += len - USB_LEN_CFG_DESC;
+  hcomp->cfg_desc[2] = LOBYTE(hcomp->cfg_len);
+  hcomp->cfg_desc[3] = HIBYTE(hcomp->cfg_len);
+
+  hcomp->entry[cls].pClass = pclass;
+  hcomp->entry[cls].pClassData = NULL;
+  hcomp->entry[cls].pUserData = pUserData;
+  if ((cls == USBD_COMPOSITE_PRIMARY) && (pUserData != NULL))
+  {
+    pdev->pUserData = pUserData;
+  }
+
+  hcomp->class_nb++;
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_GetClassData
+  *         Return the class handle (pClassData) of a class of the device
+  * @param  pdev: device instance
+  * @param  pclass: class added with USBD_COMPOSITE_AddClass
+  * @retval class handle, NULL if the class is not part of the device
+  */
+void *USBD_COMPOSITE_GetClassData(USBD_HandleTypeDef *pdev,
+                                  USBD_ClassTypeDef *pclass)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls;
+
+  for (cls = 0U; cls < hcomp->class_nb; cls++)
+  {
+    if (hcomp->entry[cls].pClass == pclass)
+    {
+      return (cls == USBD_COMPOSITE_PRIMARY) ? pdev->pClassData : hcomp->entry[cls].pClassData;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_Init
+  *         Initialize every class of the device
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t ret = USBD_OK;
+  uint8_t cls;
+
+  for (cls = 0U; cls < hcomp->class_nb; cls++)
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    if (hcomp->entry[cls].pClass->Init(pdev, cfgidx) != USBD_OK)
+    {
+      ret = USBD_FAIL;
+    }
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_DeInit
+  *         DeInitialize every class of the device
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->class_nb;
+
+  while (cls-- > 0U)
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    (void)hcomp->entry[cls].pClass->DeInit(pdev, cfgidx);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_Setup
+  *         Route a request to the class owning its interface or endpoint,
+  *         device requests go to the primary class
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_Setup(USBD_HandleTypeDef *pdev,
+                                     USBD_SetupReqTypedef *req)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = USBD_COMPOSITE_PRIMARY;
+  uint8_t num = LOBYTE(req->wIndex);
+  uint8_t ret;
+
+  switch (req->bmRequest & 0x1FU)
+  {
+    case USB_REQ_RECIPIENT_INTERFACE:
+      cls = (num < USBD_MAX_NUM_INTERFACES) ? hcomp->itf_class[num] : USBD_COMPOSITE_NO_CLASS;
+      break;
+
+    case USB_REQ_RECIPIENT_ENDPOINT:
+      cls = ((num & 0x80U) != 0U) ? hcomp->ep_in_class[num & 0xFU] : hcomp->ep_out_class[num & 0xFU];
+      break;
+
+    default:
+      break;
+  }
+
+  if ((cls == USBD_COMPOSITE_NO_CLASS) || (cls >= hcomp->class_nb))
+  {
+    USBD_CtlError(pdev, req);
+    return USBD_FAIL;
+  }
+
+  hcomp->ctl_class = cls;
+
+  USBD_COMPOSITE_Enter(pdev, cls);
+  ret = hcomp->entry[cls].pClass->Setup(pdev, req);
+  USBD_COMPOSITE_Leave(pdev, cls);
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_EP0_TxSent
+  *         Route the end of a control IN data stage to the class that
+  *         handled the request
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_EP0_TxSent(USBD_HandleTypeDef *pdev)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ctl_class;
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->EP0_TxSent != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->EP0_TxSent(pdev);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_EP0_RxReady
+  *         Route the end of a control OUT data stage to the class that
+  *         handled the request
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ctl_class;
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->EP0_RxReady != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->EP0_RxReady(pdev);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_DataIn
+  *         Route an IN transfer completion to the endpoint owner
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ep_in_class[epnum & 0xFU];
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->DataIn != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->DataIn(pdev, epnum);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_DataOut
+  *         Route an OUT transfer completion to the endpoint owner
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ep_out_class[epnum & 0xFU];
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->DataOut != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->DataOut(pdev, epnum);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_SOF
+  *         Forward the start of frame to the classes that handle it
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_SOF(USBD_HandleTypeDef *pdev)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls;
+
+  for (cls = 0U; cls < hcomp->class_nb; cls++)
+  {
+    if (hcomp->entry[cls].pClass->SOF != NULL)
+    {
+      USBD_COMPOSITE_Enter(pdev, cls);
+      (void)hcomp->entry[cls].pClass->SOF(pdev);
+      USBD_COMPOSITE_Leave(pdev, cls);
+    }
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_IsoINIncomplete
+  *         Route an incomplete isochronous IN transfer to the endpoint owner
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_IsoINIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ep_in_class[epnum & 0xFU];
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->IsoINIncomplete != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->IsoINIncomplete(pdev, epnum);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_IsoOUTIncomplete
+  *         Route an incomplete isochronous OUT transfer to the endpoint owner
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_COMPOSITE_IsoOUTIncomplete(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+  uint8_t cls = hcomp->ep_out_class[epnum & 0xFU];
+  uint8_t ret = USBD_OK;
+
+  if ((cls < hcomp->class_nb) && (hcomp->entry[cls].pClass->IsoOUTIncomplete != NULL))
+  {
+    USBD_COMPOSITE_Enter(pdev, cls);
+    ret = hcomp->entry[cls].pClass->IsoOUTIncomplete(pdev, epnum);
+    USBD_COMPOSITE_Leave(pdev, cls);
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_GetFSCfgDesc
+  *         return the configuration descriptor built by AddClass
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_COMPOSITE_GetFSCfgDesc(uint16_t *length)
+{
+  *length = hcomposite.cfg_len;
+  return hcomposite.cfg_desc;
+}
+
+/**
+  * @brief  USBD_COMPOSITE_Enter
+  *         Install the context of a secondary class in the device handle,
+  *         nothing to do for the primary class
+  * @param  pdev: device instance
+  * @param  idx: class index
+  * @retval None
+  */
+static void USBD_COMPOSITE_Enter(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+
+  if (idx != USBD_COMPOSITE_PRIMARY)
+  {
+    hcomp->primary_data = pdev->pClassData;
+    hcomp->primary_user = pdev->pUserData;
+    pdev->pClassData = hcomp->entry[idx].pClassData;
+    pdev->pUserData = hcomp->entry[idx].pUserData;
+  }
+}
+
+/**
+  * @brief  USBD_COMPOSITE_Leave
+  *         Save the context of a secondary class (Init may have allocated
+  *         it) and restore the one of the primary class
+  * @param  pdev: device instance
+  * @param  idx: class index
+  * @retval None
+  */
+static void USBD_COMPOSITE_Leave(USBD_HandleTypeDef *pdev, uint8_t idx)
+{
+  USBD_COMPOSITE_HandleTypeDef *hcomp = &hcomposite;
+
+  if (idx != USBD_COMPOSITE_PRIMARY)
+  {
+    hcomp->entry[idx].pClassData = pdev->pClassData;
+    pdev->pClassData = hcomp->primary_data;
+    pdev->pUserData = hcomp->primary_user;
+  }
+}
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
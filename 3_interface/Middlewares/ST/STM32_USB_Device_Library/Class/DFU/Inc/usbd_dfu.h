@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file    usbd_dfu.h
+  * @brief   Header file for the usbd_dfu.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_DFU_H
+#define __USB_DFU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_DFU
+  * @brief This file is the Header file for usbd_dfu.c
+  * @{
+  */
+
+
+/** @defgroup USBD_DFU_Exported_Defines
+  * @{
+  */
+#define DFU_ITF_NBR                     0x04U
+
+#define USB_DFU_CONFIG_DESC_SIZ         27U
+#define USB_DFU_DESC_SIZ                9U
+#define DFU_DESCRIPTOR_TYPE             0x21U
+
+/* wTransferSize: largest DNLOAD / UPLOAD block */
+#ifndef DFU_XFER_SIZE
+#define DFU_XFER_SIZE                   1024U
+#endif /* DFU_XFER_SIZE */
+
+/* Blocks buffered while the previous ones are programmed */
+#define DFU_BLOCK_NB                    2U
+
+/* bwPollTimeout returned while all the block buffers are in use */
+#ifndef DFU_POLL_TIMEOUT_MS
+#define DFU_POLL_TIMEOUT_MS             10U
+#endif /* DFU_POLL_TIMEOUT_MS */
+
+/* Bytes programmed by each USBD_DFU_Process call */
+#ifndef DFU_PROGRAM_CHUNK
+#define DFU_PROGRAM_CHUNK               128U
+#endif /* DFU_PROGRAM_CHUNK */
+
+/* DFU requests */
+#define DFU_DETACH                      0x00U
+#define DFU_DNLOAD                      0x01U
+#define DFU_UPLOAD                      0x02U
+#define DFU_GETSTATUS                   0x03U
+#define DFU_CLRSTATUS                   0x04U
+#define DFU_GETSTATE                    0x05U
+#define DFU_ABORT                       0x06U
+
+/* DFU states */
+#define DFU_STATE_IDLE                  0x02U
+#define DFU_STATE_DNLOAD_SYNC           0x03U
+#define DFU_STATE_DNLOAD_BUSY           0x04U
+#define DFU_STATE_DNLOAD_IDLE           0x05U
+#define DFU_STATE_MANIFEST_SYNC         0x06U
+#define DFU_STATE_MANIFEST              0x07U
+#define DFU_STATE_UPLOAD_IDLE           0x09U
+#define DFU_STATE_ERROR                 0x0AU
+
+/* DFU status */
+#define DFU_ERROR_NONE                  0x00U
+#define DFU_ERROR_WRITE                 0x03U
+#define DFU_ERROR_VERIFY                0x07U
+#define DFU_ERROR_ADDRESS               0x08U
+#define DFU_ERROR_FIRMWARE              0x0AU
+#define DFU_ERROR_STALLEDPKT            0x0FU
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_DFU_Exported_TypesDefinitions
+  * @{
+  */
+typedef struct
+{
+  int8_t   (*Init)(void);
+  int8_t   (*DeInit)(void);
+  /* Program len bytes at offset of the download area. USBD_BUSY when a
+     page was erased instead: call again with the same arguments. */
+  int8_t   (*Write)(uint32_t offset, const uint8_t *buf, uint32_t len);
+  /* Check a programmed block against its data */
+  int8_t   (*Verify)(uint32_t offset, const uint8_t *buf, uint32_t len);
+  /* Copy up to len bytes for UPLOAD, return the length copied */
+  uint32_t (*Read)(uint32_t offset, uint8_t *buf, uint32_t len);
+  /* All the image is programmed */
+  int8_t   (*Manifest)(uint32_t size);
+  /* Ask for a USBD_DFU_Process call from the main loop */
+  void     (*Schedule)(void);
+  uint32_t size;                  /* download area size */
+}
+USBD_DFU_MediaTypeDef;
+
+typedef struct
+{
+  uint8_t   buf[DFU_XFER_SIZE];
+  uint32_t  offset;               /* position in the download area */
+  uint16_t  len;                  /* padded to a word */
+  uint16_t  done;                 /* bytes programmed */
+}
+USBD_DFU_BlockTypeDef;
+
+typedef struct
+{
+  USBD_DFU_BlockTypeDef block[DFU_BLOCK_NB];
+  uint8_t   head;                 /* next block received */
+  uint8_t   tail;                 /* block programmed */
+  volatile uint8_t count;         /* blocks received, not programmed yet */
+
+  uint8_t   state;
+  uint8_t   status;
+  uint8_t   manifest_done;
+  uint32_t  AltSetting;
+  uint32_t  offset;               /* next download / upload position */
+  uint16_t  rx_len;               /* wLength of the DNLOAD in progress */
+  uint8_t   status_buf[6];
+}
+USBD_DFU_HandleTypeDef;
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_DFU_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_DFU;
+#define USBD_DFU_CLASS    &USBD_DFU
+/**
+  * @}
+  */
+
+/** @defgroup USBD_DFU_Exported_Functions
+  * @{
+  */
+void USBD_DFU_Process(USBD_HandleTypeDef *pdev);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_DFU_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
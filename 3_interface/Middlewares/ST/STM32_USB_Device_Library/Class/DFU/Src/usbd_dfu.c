@@ -0,0 +1,673 @@
+/**
+  ******************************************************************************
+  * @file    usbd_dfu.c
+  * @brief   DFU interface of the composite device.
+  *
+  * @verbatim
+  *
+  *          ===================================================================
+  *                                DFU Class Description
+  *          ===================================================================
+  *           This module manages a DFU 1.1 interface (DFU mode protocol)
+  *           next to the other classes of the device, on the control
+  *           endpoint only. Download and upload are supported, the device
+  *           is manifestation tolerant and returns to dfuIDLE once the
+  *           image is complete.
+  *
+  *           DNLOAD blocks are not programmed from the interrupt: they are
+  *           queued in DFU_BLOCK_NB buffers and programmed from the main
+  *           loop by USBD_DFU_Process, DFU_PROGRAM_CHUNK bytes at a time.
+  *           GETSTATUS reports dfuDNLOAD_IDLE as long as a buffer is free,
+  *           so the host sends the next block while the previous one is
+  *           programmed, and dfuDNBUSY only when both buffers are in use.
+  *           Each block is verified by the media once programmed.
+  *
+  *           The class handle is static: USBD_malloc only serves one block.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_dfu.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_DFU
+  * @brief usbd dfu module
+  * @{
+  */
+
+/** @defgroup USBD_DFU_Private_FunctionPrototypes
+  * @{
+  */
+
+static uint8_t  USBD_DFU_Init(USBD_HandleTypeDef *pdev,
+                              uint8_t cfgidx);
+
+static uint8_t  USBD_DFU_DeInit(USBD_HandleTypeDef *pdev,
+                                uint8_t cfgidx);
+
+static uint8_t  USBD_DFU_Setup(USBD_HandleTypeDef *pdev,
+                               USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_DFU_EP0_RxReady(USBD_HandleTypeDef *pdev);
+
+static uint8_t  *USBD_DFU_GetFSCfgDesc(uint16_t *length);
+
+static void DFU_Download(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static void DFU_Upload(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+
+static void DFU_GetStatus(USBD_HandleTypeDef *pdev);
+
+static void DFU_Reset(USBD_DFU_HandleTypeDef *hdfu);
+
+static void DFU_Error(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req,
+                      uint8_t status);
+/**
+  * @}
+  */
+
+/** @defgroup USBD_DFU_Private_Variables
+  * @{
+  */
+
+USBD_ClassTypeDef  USBD_DFU =
+{
+  USBD_DFU_Init,
+  USBD_DFU_DeInit,
+  USBD_DFU_Setup,
+  NULL, /* EP0_TxSent */
+  USBD_DFU_EP0_RxReady,
+  NULL, /* DataIn */
+  NULL, /* DataOut */
+  NULL, /* SOF */
+  NULL,
+  NULL,
+  NULL,
+  USBD_DFU_GetFSCfgDesc,
+  NULL,
+  NULL,
+};
+
+/* USB DFU device Configuration Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_DFU_CfgFSDesc[USB_DFU_CONFIG_DESC_SIZ]  __ALIGN_END =
+{
+  0x09, /* bLength: Configuration Descriptor size */
+  USB_DESC_TYPE_CONFIGURATION, /* bDescriptorType: Configuration */
+  USB_DFU_CONFIG_DESC_SIZ,
+  /* wTotalLength: Bytes returned */
+  0x00,
+  0x01,         /*bNumInterfaces: 1 interface*/
+  0x01,         /*bConfigurationValue: Configuration value*/
+  0x00,         /*iConfiguration: Index of string descriptor describing
+  the configuration*/
+  0xA0,         /*bmAttributes: bus powered and Support Remote Wake-up */
+  0x32,         /*MaxPower 100 mA: this current is used for detecting Vbus*/
+
+  /************** interface_4 ****************/
+  /* 09 */
+  0x09,         /*bLength: Interface Descriptor size*/
+  USB_DESC_TYPE_INTERFACE,/*bDescriptorType: Interface descriptor type*/
+  DFU_ITF_NBR,  /*bInterfaceNumber: Number of Interface*/
+  0x00,         /*bAlternateSetting: Alternate setting*/
+  0x00,         /*bNumEndpoints*/
+  0xFE,         /*bInterfaceClass: Application specific*/
+  0x01,         /*bInterfaceSubClass : Device Firmware Upgrade*/
+  0x02,         /*nInterfaceProtocol : DFU mode*/
+  0,            /*iInterface: Index of string descriptor*/
+  /******************** DFU functional descriptor ********************/
+  /* 18 */
+  0x09,         /*bLength: DFU Descriptor size*/
+  DFU_DESCRIPTOR_TYPE, /*bDescriptorType: DFU FUNCTIONAL*/
+  0x07,         /*bmAttributes: manifestation tolerant, upload, download*/
+  0xFF,         /*wDetachTimeOut: 255 ms*/
+  0x00,
+  LOBYTE(DFU_XFER_SIZE), /*wTransferSize*/
+  HIBYTE(DFU_XFER_SIZE),
+  0x10,         /*bcdDFUVersion: 1.1*/
+  0x01,
+  /* 27 */
+};
+
+/* Single device instance (FS) */
+static USBD_DFU_HandleTypeDef hdfu_fs;
+static USBD_DFU_MediaTypeDef *dfu_media;
+/* Incremented when the block queue is dropped, a block being programmed
+   by USBD_DFU_Process at that time is then discarded */
+static volatile uint8_t dfu_gen;
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_DFU_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_DFU_Init
+  *         Initialize the DFU interface
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_DFU_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_DFU_HandleTypeDef *hdfu = &hdfu_fs;
+
+  UNUSED(cfgidx);
+
+  if (pdev->pUserData == NULL)
+  {
+    return USBD_FAIL;
+  }
+
+  hdfu->AltSetting = 0U;
+  DFU_Reset(hdfu);
+  pdev->pClassData = hdfu;
+  dfu_media = (USBD_DFU_MediaTypeDef *)pdev->pUserData;
+
+  return (dfu_media->Init() == 0) ? USBD_OK : USBD_FAIL;
+}
+
+/**
+  * @brief  USBD_DFU_DeInit
+  *         DeInitialize the DFU interface, an unfinished download is lost
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_DFU_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  UNUSED(cfgidx);
+
+  if (pdev->pClassData != NULL)
+  {
+    DFU_Reset(&hdfu_fs);
+    (void)dfu_media->DeInit();
+    dfu_media = NULL;
+    pdev->pClassData = NULL;
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_DFU_Setup
+  *         Handle the DFU specific requests
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_DFU_Setup(USBD_HandleTypeDef *pdev,
+                               USBD_SetupReqTypedef *req)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+  uint16_t status_info = 0U;
+  uint8_t ret = USBD_OK;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+    case USB_REQ_TYPE_CLASS :
+      switch (req->bRequest)
+      {
+        case DFU_DNLOAD:
+          DFU_Download(pdev, req);
+          break;
+
+        case DFU_UPLOAD:
+          DFU_Upload(pdev, req);
+          break;
+
+        case DFU_GETSTATUS:
+          DFU_GetStatus(pdev);
+          break;
+
+        case DFU_CLRSTATUS:
+        case DFU_ABORT:
+          DFU_Reset(hdfu);
+          break;
+
+        case DFU_GETSTATE:
+          USBD_CtlSendData(pdev, &hdfu->state, 1U);
+          break;
+
+        case DFU_DETACH:
+          /* Already in DFU mode */
+          break;
+
+        default:
+          USBD_CtlError(pdev, req);
+          ret = USBD_FAIL;
+          break;
+      }
+      break;
+
+    case USB_REQ_TYPE_STANDARD:
+      switch (req->bRequest)
+      {
+        case USB_REQ_GET_STATUS:
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            USBD_CtlSendData(pdev, (uint8_t *)(void *)&status_info, 2U);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        case USB_REQ_GET_DESCRIPTOR:
+          if ((req->wValue >> 8) == DFU_DESCRIPTOR_TYPE)
+          {
+            USBD_CtlSendData(pdev, USBD_DFU_CfgFSDesc + 18,
+                             MIN(USB_DFU_DESC_SIZ, req->wLength));
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        case USB_REQ_GET_INTERFACE :
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            USBD_CtlSendData(pdev, (uint8_t *)(void *)&hdfu->AltSetting, 1U);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        case USB_REQ_SET_INTERFACE :
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            hdfu->AltSetting = (uint8_t)(req->wValue);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        default:
+          USBD_CtlError(pdev, req);
+          ret = USBD_FAIL;
+          break;
+      }
+      break;
+
+    default:
+      USBD_CtlError(pdev, req);
+      ret = USBD_FAIL;
+      break;
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_DFU_EP0_RxReady
+  *         Queue the DNLOAD block just received for programming
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_DFU_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+  USBD_DFU_BlockTypeDef *blk;
+  uint16_t len;
+
+  if (hdfu->rx_len == 0U)
+  {
+    return USBD_OK;
+  }
+
+  blk = &hdfu->block[hdfu->head];
+  len = hdfu->rx_len;
+  hdfu->rx_len = 0U;
+
+  /* Pad the last block of the image to a word with erased flash bytes */
+  while ((len & 3U) != 0U)
+  {
+    blk->buf[len++] = 0xFFU;
+  }
+  blk->offset = hdfu->offset;
+  blk->len = len;
+  blk->done = 0U;
+
+  hdfu->offset += len;
+  hdfu->head = (hdfu->head + 1U) % DFU_BLOCK_NB;
+  hdfu->count++;
+  hdfu->state = DFU_STATE_DNLOAD_SYNC;
+
+  dfu_media->Schedule();
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_DFU_GetFSCfgDesc
+  *         return FS configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_DFU_GetFSCfgDesc(uint16_t *length)
+{
+  *length = sizeof(USBD_DFU_CfgFSDesc);
+  return USBD_DFU_CfgFSDesc;
+}
+
+/**
+  * @brief  DFU_Download
+  *         Handle a DNLOAD request: receive a block, or start the
+  *         manifestation when the block is empty
+  * @param  pdev: device instance
+  * @param  req: usb request
+  * @retval None
+  */
+static void DFU_Download(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+
+  if (req->wLength == 0U)
+  {
+    if (hdfu->state != DFU_STATE_DNLOAD_IDLE)
+    {
+      DFU_Error(pdev, req, DFU_ERROR_STALLEDPKT);
+      return;
+    }
+    hdfu->manifest_done = 0U;
+    hdfu->state = DFU_STATE_MANIFEST_SYNC;
+    dfu_media->Schedule();
+    return;
+  }
+
+  if (hdfu->state == DFU_STATE_IDLE)
+  {
+    hdfu->offset = 0U;
+  }
+  else if (hdfu->state != DFU_STATE_DNLOAD_IDLE)
+  {
+    DFU_Error(pdev, req, DFU_ERROR_STALLEDPKT);
+    return;
+  }
+
+  if ((req->wLength > DFU_XFER_SIZE) || (hdfu->count >= DFU_BLOCK_NB))
+  {
+    DFU_Error(pdev, req, DFU_ERROR_STALLEDPKT);
+    return;
+  }
+
+  if ((hdfu->offset + req->wLength) > dfu_media->size)
+  {
+    DFU_Error(pdev, req, DFU_ERROR_ADDRESS);
+    return;
+  }
+
+  hdfu->rx_len = req->wLength;
+  USBD_CtlPrepareRx(pdev, hdfu->block[hdfu->head].buf, req->wLength);
+}
+
+/**
+  * @brief  DFU_Upload
+  *         Handle an UPLOAD request, a short block ends the upload
+  * @param  pdev: device instance
+  * @param  req: usb request
+  * @retval None
+  */
+static void DFU_Upload(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+  uint32_t len;
+
+  if (hdfu->state == DFU_STATE_IDLE)
+  {
+    hdfu->offset = 0U;
+  }
+  else if (hdfu->state != DFU_STATE_UPLOAD_IDLE)
+  {
+    DFU_Error(pdev, req, DFU_ERROR_STALLEDPKT);
+    return;
+  }
+
+  /* No download in progress: the block buffers are free */
+  len = MIN(req->wLength, DFU_XFER_SIZE);
+  if (hdfu->offset < dfu_media->size)
+  {
+    len = dfu_media->Read(hdfu->offset, hdfu->block[0].buf,
+                          MIN(len, dfu_media->size - hdfu->offset));
+  }
+  else
+  {
+    len = 0U;
+  }
+  hdfu->offset += len;
+  hdfu->state = (len < req->wLength) ? DFU_STATE_IDLE : DFU_STATE_UPLOAD_IDLE;
+
+  USBD_CtlSendData(pdev, hdfu->block[0].buf, (uint16_t)len);
+}
+
+/**
+  * @brief  DFU_GetStatus
+  *         Handle a GETSTATUS request, advancing the download and
+  *         manifestation states
+  * @param  pdev: device instance
+  * @retval None
+  */
+static void DFU_GetStatus(USBD_HandleTypeDef *pdev)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+  uint32_t poll = 0U;
+
+  switch (hdfu->state)
+  {
+    case DFU_STATE_DNLOAD_SYNC:
+    case DFU_STATE_DNLOAD_BUSY:
+      if (hdfu->count < DFU_BLOCK_NB)
+      {
+        hdfu->state = DFU_STATE_DNLOAD_IDLE;
+      }
+      else
+      {
+        hdfu->state = DFU_STATE_DNLOAD_BUSY;
+        poll = DFU_POLL_TIMEOUT_MS;
+      }
+      break;
+
+    case DFU_STATE_MANIFEST_SYNC:
+    case DFU_STATE_MANIFEST:
+      if (hdfu->manifest_done != 0U)
+      {
+        hdfu->state = DFU_STATE_IDLE;
+      }
+      else
+      {
+        hdfu->state = DFU_STATE_MANIFEST;
+        poll = DFU_POLL_TIMEOUT_MS;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  hdfu->status_buf[0] = hdfu->status;
+  hdfu->status_buf[1] = (uint8_t)poll;
+  hdfu->status_buf[2] = (uint8_t)(poll >> 8);
+  hdfu->status_buf[3] = (uint8_t)(poll >> 16);
+  hdfu->status_buf[4] = hdfu->state;
+  hdfu->status_buf[5] = 0U;
+
+  USBD_CtlSendData(pdev, hdfu->status_buf, 6U);
+}
+
+/**
+  * @brief  DFU_Reset
+  *         Drop the queued blocks and return to dfuIDLE
+  * @param  hdfu: DFU handle
+  * @retval None
+  */
+static void DFU_Reset(USBD_DFU_HandleTypeDef *hdfu)
+{
+  dfu_gen++;
+  hdfu->head = 0U;
+  hdfu->tail = 0U;
+  hdfu->count = 0U;
+  hdfu->rx_len = 0U;
+  hdfu->offset = 0U;
+  hdfu->manifest_done = 0U;
+  hdfu->status = DFU_ERROR_NONE;
+  hdfu->state = DFU_STATE_IDLE;
+}
+
+/**
+  * @brief  DFU_Error
+  *         Stall a request and enter dfuERROR
+  * @param  pdev: device instance
+  * @param  req: usb request
+  * @param  status: DFU status reported by the next GETSTATUS
+  * @retval None
+  */
+static void DFU_Error(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req,
+                      uint8_t status)
+{
+  USBD_DFU_HandleTypeDef *hdfu = (USBD_DFU_HandleTypeDef *)pdev->pClassData;
+
+  DFU_Reset(hdfu);
+  hdfu->status = status;
+  hdfu->state = DFU_STATE_ERROR;
+  USBD_CtlError(pdev, req);
+}
+
+/**
+  * @brief  USBD_DFU_Process
+  *         Program the next chunk of the oldest queued block, or run the
+  *         manifestation once every block is programmed. Called from the
+  *         main loop after the media Schedule callback.
+  * @param  pdev: device instance
+  * @retval None
+  */
+void USBD_DFU_Process(USBD_HandleTypeDef *pdev)
+{
+  USBD_DFU_HandleTypeDef *hdfu = &hdfu_fs;
+  USBD_DFU_MediaTypeDef *media = dfu_media;
+  USBD_DFU_BlockTypeDef *blk;
+  uint32_t primask;
+  uint32_t chunk;
+  uint8_t gen = dfu_gen;
+  uint8_t status = DFU_ERROR_NONE;
+  uint8_t more;
+  int8_t ret;
+
+  UNUSED(pdev);
+
+  if (media == NULL)
+  {
+    return;
+  }
+
+  if (hdfu->count == 0U)
+  {
+    if (((hdfu->state == DFU_STATE_MANIFEST_SYNC) || (hdfu->state == DFU_STATE_MANIFEST)) &&
+        (hdfu->manifest_done == 0U))
+    {
+      if (media->Manifest(hdfu->offset) != 0)
+      {
+        status = DFU_ERROR_FIRMWARE;
+      }
+      primask = __get_PRIMASK();
+      __disable_irq();
+      if (gen == dfu_gen)
+      {
+        if (status != DFU_ERROR_NONE)
+        {
+          DFU_Reset(hdfu);
+          hdfu->status = status;
+          hdfu->state = DFU_STATE_ERROR;
+        }
+        else
+        {
+          hdfu->manifest_done = 1U;
+        }
+      }
+      __set_PRIMASK(primask);
+    }
+    return;
+  }
+
+  blk = &hdfu->block[hdfu->tail];
+  chunk = MIN(DFU_PROGRAM_CHUNK, (uint32_t)blk->len - blk->done);
+
+  ret = media->Write(blk->offset + blk->done, &blk->buf[blk->done], chunk);
+  if (ret == (int8_t)USBD_OK)
+  {
+    if ((blk->done + chunk) == blk->len)
+    {
+      if (media->Verify(blk->offset, blk->buf, blk->len) != 0)
+      {
+        status = DFU_ERROR_VERIFY;
+      }
+    }
+  }
+  else if (ret != (int8_t)USBD_BUSY)
+  {
+    status = DFU_ERROR_WRITE;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (gen == dfu_gen)
+  {
+    if (status != DFU_ERROR_NONE)
+    {
+      DFU_Reset(hdfu);
+      hdfu->status = status;
+      hdfu->state = DFU_STATE_ERROR;
+    }
+    else if (ret == (int8_t)USBD_OK)
+    {
+      blk->done += (uint16_t)chunk;
+      if (blk->done == blk->len)
+      {
+        hdfu->tail = (hdfu->tail + 1U) % DFU_BLOCK_NB;
+        hdfu->count--;
+      }
+    }
+  }
+  more = ((hdfu->count != 0U) || (hdfu->state == DFU_STATE_MANIFEST_SYNC) ||
+          (hdfu->state == DFU_STATE_MANIFEST)) ? 1U : 0U;
+  __set_PRIMASK(primask);
+
+  if (more != 0U)
+  {
+    media->Schedule();
+  }
+}
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
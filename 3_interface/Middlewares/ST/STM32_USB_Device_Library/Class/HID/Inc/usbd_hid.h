@@ -47,6 +47,10 @@ extern "C" {
 #define HID_EPIN_2_ADDR                 0x82U
 #define HID_EPIN_3_ADDR                 0x83U
 
+#define HID_KEYBOARD_ITF                0x00U
+#define HID_MOUSE_ITF                   0x01U
+#define HID_DIAL_ITF                    0x02U
+
 #define HID_EPIN_SIZE                 0x04U
 
 #define  EP1_PACKET_SIZE         0x08U          
@@ -79,6 +83,14 @@ extern "C" {
 
 #define HID_REQ_SET_REPORT            0x09U
 #define HID_REQ_GET_REPORT            0x01U
+
+#define HID_REPORT_TYPE_INPUT         0x01U
+#define HID_REPORT_TYPE_OUTPUT        0x02U
+#define HID_REPORT_TYPE_FEATURE       0x03U
+
+#ifndef HID_EP0_REPORT_BUF_SIZE
+#define HID_EP0_REPORT_BUF_SIZE       0x40U
+#endif /* HID_EP0_REPORT_BUF_SIZE */
 /**
   * @}
   */
@@ -101,8 +113,22 @@ typedef struct
   uint32_t             IdleState;
   uint32_t             AltSetting;
   HID_StateTypeDef     state;
+  uint8_t              ReportItf;
+  uint8_t              ReportType;
+  uint8_t              ReportId;
+  uint16_t             ReportLength;
+  uint8_t              Report_buf[HID_EP0_REPORT_BUF_SIZE];
 }
 USBD_HID_HandleTypeDef;
+
+/* Report callbacks for the EP0 SET_REPORT / GET_REPORT requests.
+   itf is the interface number from wIndex, type/id come from wValue. */
+typedef struct
+{
+  int8_t    (*SetReport)(uint8_t itf, uint8_t type, uint8_t id, uint8_t *report, uint16_t len);
+  uint8_t  *(*GetReport)(uint8_t itf, uint8_t type, uint8_t id, uint16_t *len);
+}
+USBD_HID_ItfTypeDef;
 /**
   * @}
   */
@@ -136,6 +162,9 @@ uint8_t USBD_HID_SendReport(USBD_HandleTypeDef *pdev,
 
 uint32_t USBD_HID_GetPollingInterval(USBD_HandleTypeDef *pdev);
 
+uint8_t USBD_HID_RegisterInterface(USBD_HandleTypeDef *pdev,
+                                   USBD_HID_ItfTypeDef *fops);
+
 /**
   * @}
   */
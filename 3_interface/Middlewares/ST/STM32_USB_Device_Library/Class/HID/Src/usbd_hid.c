@@ -108,6 +108,8 @@ static uint8_t  *USBD_HID_GetOtherSpeedCfgDesc(uint16_t *length);
 static uint8_t  *USBD_HID_GetDeviceQualifierDesc(uint16_t *length);
 #endif
 static uint8_t  USBD_HID_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev);
 /**
   * @}
   */
@@ -122,7 +124,7 @@ USBD_ClassTypeDef  USBD_HID =
   USBD_HID_DeInit,
   USBD_HID_Setup,
   NULL, /*EP0_TxSent*/
-  NULL, /*EP0_RxReady*/
+  USBD_HID_EP0_RxReady, /*EP0_RxReady*/
   USBD_HID_DataIn, /*DataIn*/
   NULL, /*DataOut*/
   NULL, /*SOF */
@@ -702,6 +704,34 @@ static uint8_t  USBD_HID_Setup(USBD_HandleTypeDef *pdev,
           USBD_CtlSendData(pdev, (uint8_t *)(void *)&hhid->IdleState, 1U);
           break;
 
+        case HID_REQ_SET_REPORT:
+          hhid->ReportItf = LOBYTE(req->wIndex);
+          hhid->ReportType = HIBYTE(req->wValue);
+          hhid->ReportId = LOBYTE(req->wValue);
+          hhid->ReportLength = MIN(req->wLength, HID_EP0_REPORT_BUF_SIZE);
+          if (hhid->ReportLength != 0U)
+          {
+            USBD_CtlPrepareRx(pdev, hhid->Report_buf, hhid->ReportLength);
+          }
+          break;
+
+        case HID_REQ_GET_REPORT:
+          if (pdev->pUserData != NULL)
+          {
+            pbuf = ((USBD_HID_ItfTypeDef *)pdev->pUserData)->GetReport(LOBYTE(req->wIndex),
+                                                                      HIBYTE(req->wValue),
+                                                                      LOBYTE(req->wValue),
+                                                                      &len);
+          }
+          if (pbuf == NULL)
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+            break;
+          }
+          USBD_CtlSendData(pdev, pbuf, MIN(len, req->wLength));
+          break;
+
         default:
           USBD_CtlError(pdev, req);
           ret = USBD_FAIL;
@@ -851,6 +881,27 @@ uint8_t USBD_HID_SendReport(USBD_HandleTypeDef  *pdev,
   return USBD_OK;
 }
 
+/**
+  * @brief  USBD_HID_RegisterInterface
+  *         Register the SET_REPORT / GET_REPORT callbacks
+  * @param  pdev: device instance
+  * @param  fops: report callbacks
+  * @retval status
+  */
+uint8_t USBD_HID_RegisterInterface(USBD_HandleTypeDef *pdev,
+                                   USBD_HID_ItfTypeDef *fops)
+{
+  uint8_t ret = USBD_FAIL;
+
+  if (fops != NULL)
+  {
+    pdev->pUserData = fops;
+    ret = USBD_OK;
+  }
+
+  return ret;
+}
+
 /**
   * @brief  USBD_HID_GetPollingInterval
   *         return polling interval from endpoint descriptor
@@ -937,6 +988,29 @@ static uint8_t  USBD_HID_DataIn(USBD_HandleTypeDef *pdev,
   return USBD_OK;
 }
 
+/**
+  * @brief  USBD_HID_EP0_RxReady
+  *         Handle the data stage of a SET_REPORT request
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_HID_EP0_RxReady(USBD_HandleTypeDef *pdev)
+{
+  USBD_HID_HandleTypeDef *hhid = (USBD_HID_HandleTypeDef *)pdev->pClassData;
+
+  if ((hhid != NULL) && (pdev->pUserData != NULL) && (hhid->ReportLength != 0U))
+  {
+    ((USBD_HID_ItfTypeDef *)pdev->pUserData)->SetReport(hhid->ReportItf,
+                                                         hhid->ReportType,
+                                                         hhid->ReportId,
+                                                         hhid->Report_buf,
+                                                         hhid->ReportLength);
+    hhid->ReportLength = 0U;
+  }
+
+  return USBD_OK;
+}
+
 #if 0
 /**
 * @brief  DeviceQualifierDescriptor
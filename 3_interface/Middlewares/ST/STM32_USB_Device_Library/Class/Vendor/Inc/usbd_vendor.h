@@ -0,0 +1,127 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor.h
+  * @brief   Header file for the usbd_vendor.c file.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_VENDOR_H
+#define __USB_VENDOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include  "usbd_ioreq.h"
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+/** @defgroup USBD_VENDOR
+  * @brief This file is the Header file for usbd_vendor.c
+  * @{
+  */
+
+
+/** @defgroup USBD_VENDOR_Exported_Defines
+  * @{
+  */
+#define VENDOR_ITF_NBR                  0x03U
+#define VENDOR_EPIN_ADDR                0x84U
+#define VENDOR_EPOUT_ADDR               0x04U
+#define VENDOR_DATA_FS_MAX_PACKET_SIZE  0x40U
+
+#define USB_VENDOR_CONFIG_DESC_SIZ      32U
+
+/* Frame: sync, command, sequence, status, payload length (2, LE), payload */
+#define VENDOR_FRAME_SYNC               0xA5U
+#define VENDOR_FRAME_HEADER_SIZE        6U
+#ifndef VENDOR_FRAME_MAX_SIZE
+#define VENDOR_FRAME_MAX_SIZE           256U
+#endif /* VENDOR_FRAME_MAX_SIZE */
+#define VENDOR_FRAME_MAX_PAYLOAD        (VENDOR_FRAME_MAX_SIZE - VENDOR_FRAME_HEADER_SIZE)
+
+/* Replies carry the command with this bit set */
+#define VENDOR_FRAME_REPLY              0x80U
+/**
+  * @}
+  */
+
+
+/** @defgroup USBD_VENDOR_Exported_TypesDefinitions
+  * @{
+  */
+typedef struct
+{
+  int8_t (*Init)(void);
+  int8_t (*DeInit)(void);
+  /* Complete frame received, called from the USB interrupt */
+  int8_t (*Receive)(uint8_t cmd, uint8_t seq, uint8_t *payload, uint16_t len);
+  /* A transmit buffer became free */
+  void   (*TxComplete)(void);
+}
+USBD_VENDOR_ItfTypeDef;
+
+typedef struct
+{
+  uint32_t  AltSetting;
+
+  /* OUT: two packet buffers, the endpoint is re-armed on one while the
+     other is parsed into the frame buffer */
+  uint8_t   rx_packet[2][VENDOR_DATA_FS_MAX_PACKET_SIZE];
+  uint8_t   rx_ping;
+  uint8_t   rx_frame[VENDOR_FRAME_MAX_SIZE];
+  uint16_t  rx_count;
+  uint16_t  rx_expected;
+  uint32_t  rx_dropped;
+
+  /* IN: two frame buffers, one is sent while the other is filled */
+  uint8_t   tx_frame[2][VENDOR_FRAME_MAX_SIZE];
+  uint16_t  tx_len[2];
+  uint8_t   tx_active;            /* buffer on the endpoint */
+  uint8_t   tx_busy;              /* endpoint transfer in progress */
+  uint8_t   tx_pending;           /* other buffer holds a frame */
+  uint8_t   tx_zlp;
+}
+USBD_VENDOR_HandleTypeDef;
+/**
+  * @}
+  */
+
+
+
+/** @defgroup USBD_VENDOR_Exported_Variables
+  * @{
+  */
+
+extern USBD_ClassTypeDef  USBD_VENDOR;
+#define USBD_VENDOR_CLASS    &USBD_VENDOR
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_Exported_Functions
+  * @{
+  */
+uint8_t USBD_VENDOR_SendFrame(USBD_HandleTypeDef *pdev, uint8_t cmd, uint8_t seq,
+                              uint8_t status, const uint8_t *payload, uint16_t len);
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __USB_VENDOR_H */
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
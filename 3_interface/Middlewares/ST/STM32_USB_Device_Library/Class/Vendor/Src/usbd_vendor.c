@@ -0,0 +1,502 @@
+/**
+  ******************************************************************************
+  * @file    usbd_vendor.c
+  * @brief   Vendor specific bulk interface.
+  *
+  * @verbatim
+  *
+  *          ===================================================================
+  *                                Vendor Class Description
+  *          ===================================================================
+  *           One vendor specific interface (class 0xFF) with a bulk IN and a
+  *           bulk OUT endpoint, used for configuration and telemetry.
+  *           Both directions carry frames:
+  *             [0xA5][command][sequence][status][length LSB][length MSB][payload]
+  *           A frame starts a transfer and may span several packets; a
+  *           short packet ends the transfer, an incomplete frame is dropped.
+  *
+  *           The endpoints are single buffered in the PMA, the ping-pong is
+  *           done in RAM: the OUT endpoint is re-armed on the second packet
+  *           buffer before the received packet is parsed, and a frame can be
+  *           queued in the second IN buffer while the first one is sent.
+  *
+  *           The class handle is static: USBD_malloc only serves one block.
+  *
+  *  @endverbatim
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_vendor.h"
+#include "usbd_ctlreq.h"
+
+
+/** @addtogroup STM32_USB_DEVICE_LIBRARY
+  * @{
+  */
+
+
+/** @defgroup USBD_VENDOR
+  * @brief usbd vendor module
+  * @{
+  */
+
+/** @defgroup USBD_VENDOR_Private_FunctionPrototypes
+  * @{
+  */
+
+static uint8_t  USBD_VENDOR_Init(USBD_HandleTypeDef *pdev,
+                                 uint8_t cfgidx);
+
+static uint8_t  USBD_VENDOR_DeInit(USBD_HandleTypeDef *pdev,
+                                   uint8_t cfgidx);
+
+static uint8_t  USBD_VENDOR_Setup(USBD_HandleTypeDef *pdev,
+                                  USBD_SetupReqTypedef *req);
+
+static uint8_t  USBD_VENDOR_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  USBD_VENDOR_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+
+static uint8_t  *USBD_VENDOR_GetFSCfgDesc(uint16_t *length);
+
+static void USBD_VENDOR_StartTx(USBD_HandleTypeDef *pdev,
+                                USBD_VENDOR_HandleTypeDef *hvnd);
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_Private_Variables
+  * @{
+  */
+
+USBD_ClassTypeDef  USBD_VENDOR =
+{
+  USBD_VENDOR_Init,
+  USBD_VENDOR_DeInit,
+  USBD_VENDOR_Setup,
+  NULL, /* EP0_TxSent */
+  NULL, /* EP0_RxReady */
+  USBD_VENDOR_DataIn,
+  USBD_VENDOR_DataOut,
+  NULL, /* SOF */
+  NULL,
+  NULL,
+  NULL,
+  USBD_VENDOR_GetFSCfgDesc,
+  NULL,
+  NULL,
+};
+
+/* USB vendor device Configuration Descriptor */
+__ALIGN_BEGIN static uint8_t USBD_VENDOR_CfgFSDesc[USB_VENDOR_CONFIG_DESC_SIZ]  __ALIGN_END =
+{
+  0x09, /* bLength: Configuration Descriptor size */
+  USB_DESC_TYPE_CONFIGURATION, /* bDescriptorType: Configuration */
+  USB_VENDOR_CONFIG_DESC_SIZ,
+  /* wTotalLength: Bytes returned */
+  0x00,
+  0x01,         /*bNumInterfaces: 1 interface*/
+  0x01,         /*bConfigurationValue: Configuration value*/
+  0x00,         /*iConfiguration: Index of string descriptor describing
+  the configuration*/
+  0xA0,         /*bmAttributes: bus powered and Support Remote Wake-up */
+  0x32,         /*MaxPower 100 mA: this current is used for detecting Vbus*/
+
+  /************** interface_3 ****************/
+  /* 09 */
+  0x09,         /*bLength: Interface Descriptor size*/
+  USB_DESC_TYPE_INTERFACE,/*bDescriptorType: Interface descriptor type*/
+  VENDOR_ITF_NBR, /*bInterfaceNumber: Number of Interface*/
+  0x00,         /*bAlternateSetting: Alternate setting*/
+  0x02,         /*bNumEndpoints*/
+  0xFF,         /*bInterfaceClass: Vendor specific*/
+  0x00,         /*bInterfaceSubClass*/
+  0x00,         /*nInterfaceProtocol*/
+  0,            /*iInterface: Index of string descriptor*/
+  /******************** endpoint OUT ********************/
+  /* 18 */
+  0x07,          /*bLength: Endpoint Descriptor size*/
+  USB_DESC_TYPE_ENDPOINT, /*bDescriptorType:*/
+  VENDOR_EPOUT_ADDR,   /*bEndpointAddress: Endpoint Address (OUT)*/
+  0x02,          /*bmAttributes: Bulk endpoint*/
+  LOBYTE(VENDOR_DATA_FS_MAX_PACKET_SIZE), /*wMaxPacketSize*/
+  HIBYTE(VENDOR_DATA_FS_MAX_PACKET_SIZE),
+  0x00,          /*bInterval: ignored for Bulk transfer*/
+  /******************** endpoint IN ********************/
+  /* 25 */
+  0x07,          /*bLength: Endpoint Descriptor size*/
+  USB_DESC_TYPE_ENDPOINT, /*bDescriptorType:*/
+  VENDOR_EPIN_ADDR,    /*bEndpointAddress: Endpoint Address (IN)*/
+  0x02,          /*bmAttributes: Bulk endpoint*/
+  LOBYTE(VENDOR_DATA_FS_MAX_PACKET_SIZE), /*wMaxPacketSize*/
+  HIBYTE(VENDOR_DATA_FS_MAX_PACKET_SIZE),
+  0x00,          /*bInterval: ignored for Bulk transfer*/
+  /* 32 */
+};
+
+/* Single device instance (FS) */
+static USBD_VENDOR_HandleTypeDef hvendor;
+static uint8_t hvendor_open;
+
+/**
+  * @}
+  */
+
+/** @defgroup USBD_VENDOR_Private_Functions
+  * @{
+  */
+
+/**
+  * @brief  USBD_VENDOR_Init
+  *         Initialize the vendor interface
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_VENDOR_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_VENDOR_HandleTypeDef *hvnd = &hvendor;
+
+  UNUSED(cfgidx);
+
+  USBD_LL_OpenEP(pdev, VENDOR_EPIN_ADDR, USBD_EP_TYPE_BULK, VENDOR_DATA_FS_MAX_PACKET_SIZE);
+  pdev->ep_in[VENDOR_EPIN_ADDR & 0xFU].is_used = 1U;
+
+  USBD_LL_OpenEP(pdev, VENDOR_EPOUT_ADDR, USBD_EP_TYPE_BULK, VENDOR_DATA_FS_MAX_PACKET_SIZE);
+  pdev->ep_out[VENDOR_EPOUT_ADDR & 0xFU].is_used = 1U;
+
+  memset(hvnd, 0, sizeof(USBD_VENDOR_HandleTypeDef));
+  pdev->pClassData = hvnd;
+
+  if (pdev->pUserData != NULL)
+  {
+    (void)((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Init();
+  }
+
+  hvendor_open = 1U;
+
+  USBD_LL_PrepareReceive(pdev, VENDOR_EPOUT_ADDR, hvnd->rx_packet[0],
+                         VENDOR_DATA_FS_MAX_PACKET_SIZE);
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_VENDOR_DeInit
+  *         DeInitialize the vendor interface
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t  USBD_VENDOR_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  UNUSED(cfgidx);
+
+  hvendor_open = 0U;
+
+  USBD_LL_CloseEP(pdev, VENDOR_EPIN_ADDR);
+  pdev->ep_in[VENDOR_EPIN_ADDR & 0xFU].is_used = 0U;
+
+  USBD_LL_CloseEP(pdev, VENDOR_EPOUT_ADDR);
+  pdev->ep_out[VENDOR_EPOUT_ADDR & 0xFU].is_used = 0U;
+
+  if (pdev->pClassData != NULL)
+  {
+    if (pdev->pUserData != NULL)
+    {
+      (void)((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->DeInit();
+    }
+    pdev->pClassData = NULL;
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_VENDOR_Setup
+  *         Handle the vendor interface requests, the interface has no
+  *         class request
+  * @param  pdev: instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t  USBD_VENDOR_Setup(USBD_HandleTypeDef *pdev,
+                                  USBD_SetupReqTypedef *req)
+{
+  USBD_VENDOR_HandleTypeDef *hvnd = (USBD_VENDOR_HandleTypeDef *)pdev->pClassData;
+  uint16_t status_info = 0U;
+  uint8_t ret = USBD_OK;
+
+  switch (req->bmRequest & USB_REQ_TYPE_MASK)
+  {
+    case USB_REQ_TYPE_STANDARD:
+      switch (req->bRequest)
+      {
+        case USB_REQ_GET_STATUS:
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            USBD_CtlSendData(pdev, (uint8_t *)(void *)&status_info, 2U);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        case USB_REQ_GET_INTERFACE :
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            USBD_CtlSendData(pdev, (uint8_t *)(void *)&hvnd->AltSetting, 1U);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        case USB_REQ_SET_INTERFACE :
+          if (pdev->dev_state == USBD_STATE_CONFIGURED)
+          {
+            hvnd->AltSetting = (uint8_t)(req->wValue);
+          }
+          else
+          {
+            USBD_CtlError(pdev, req);
+            ret = USBD_FAIL;
+          }
+          break;
+
+        default:
+          USBD_CtlError(pdev, req);
+          ret = USBD_FAIL;
+          break;
+      }
+      break;
+
+    default:
+      USBD_CtlError(pdev, req);
+      ret = USBD_FAIL;
+      break;
+  }
+
+  return ret;
+}
+
+/**
+  * @brief  USBD_VENDOR_DataIn
+  *         Finish the frame on the IN endpoint and start the queued one
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_VENDOR_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_VENDOR_HandleTypeDef *hvnd = (USBD_VENDOR_HandleTypeDef *)pdev->pClassData;
+
+  UNUSED(epnum);
+
+  if (hvnd->tx_zlp != 0U)
+  {
+    /* Frame was a multiple of the packet size: terminate the transfer */
+    hvnd->tx_zlp = 0U;
+    USBD_LL_Transmit(pdev, VENDOR_EPIN_ADDR, NULL, 0U);
+    return USBD_OK;
+  }
+
+  hvnd->tx_busy = 0U;
+  if (hvnd->tx_pending != 0U)
+  {
+    hvnd->tx_pending = 0U;
+    hvnd->tx_active ^= 1U;
+    USBD_VENDOR_StartTx(pdev, hvnd);
+  }
+
+  if ((pdev->pUserData != NULL) &&
+      (((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->TxComplete != NULL))
+  {
+    ((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->TxComplete();
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_VENDOR_DataOut
+  *         Re-arm the OUT endpoint on the other packet buffer, then add the
+  *         received packet to the frame being assembled
+  * @param  pdev: device instance
+  * @param  epnum: endpoint index
+  * @retval status
+  */
+static uint8_t  USBD_VENDOR_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_VENDOR_HandleTypeDef *hvnd = (USBD_VENDOR_HandleTypeDef *)pdev->pClassData;
+  uint8_t *packet = hvnd->rx_packet[hvnd->rx_ping];
+  uint16_t count = (uint16_t)USBD_LL_GetRxDataSize(pdev, epnum);
+  uint16_t room;
+
+  hvnd->rx_ping ^= 1U;
+  USBD_LL_PrepareReceive(pdev, VENDOR_EPOUT_ADDR, hvnd->rx_packet[hvnd->rx_ping],
+                         VENDOR_DATA_FS_MAX_PACKET_SIZE);
+
+  if ((hvnd->rx_count == 0U) && ((count == 0U) || (packet[0] != VENDOR_FRAME_SYNC)))
+  {
+    /* Not the start of a frame */
+    if (count != 0U)
+    {
+      hvnd->rx_dropped++;
+    }
+    return USBD_OK;
+  }
+
+  room = VENDOR_FRAME_MAX_SIZE - hvnd->rx_count;
+  memcpy(&hvnd->rx_frame[hvnd->rx_count], packet, MIN(count, room));
+  hvnd->rx_count += MIN(count, room);
+
+  if ((hvnd->rx_expected == 0U) && (hvnd->rx_count >= VENDOR_FRAME_HEADER_SIZE))
+  {
+    hvnd->rx_expected = VENDOR_FRAME_HEADER_SIZE +
+                        (uint16_t)(hvnd->rx_frame[4] | ((uint16_t)hvnd->rx_frame[5] << 8));
+    if (hvnd->rx_expected > VENDOR_FRAME_MAX_SIZE)
+    {
+      hvnd->rx_dropped++;
+      hvnd->rx_count = 0U;
+      hvnd->rx_expected = 0U;
+      return USBD_OK;
+    }
+  }
+
+  if ((hvnd->rx_expected != 0U) && (hvnd->rx_count >= hvnd->rx_expected))
+  {
+    if (pdev->pUserData != NULL)
+    {
+      (void)((USBD_VENDOR_ItfTypeDef *)pdev->pUserData)->Receive(hvnd->rx_frame[1],
+                                                                 hvnd->rx_frame[2],
+                                                                 &hvnd->rx_frame[VENDOR_FRAME_HEADER_SIZE],
+                                                                 hvnd->rx_expected - VENDOR_FRAME_HEADER_SIZE);
+    }
+    hvnd->rx_count = 0U;
+    hvnd->rx_expected = 0U;
+  }
+  else if (count < VENDOR_DATA_FS_MAX_PACKET_SIZE)
+  {
+    /* Short packet before the end of the frame */
+    hvnd->rx_dropped++;
+    hvnd->rx_count = 0U;
+    hvnd->rx_expected = 0U;
+  }
+
+  return USBD_OK;
+}
+
+/**
+  * @brief  USBD_VENDOR_GetFSCfgDesc
+  *         return FS configuration descriptor
+  * @param  length : pointer data length
+  * @retval pointer to descriptor buffer
+  */
+static uint8_t  *USBD_VENDOR_GetFSCfgDesc(uint16_t *length)
+{
+  *length = sizeof(USBD_VENDOR_CfgFSDesc);
+  return USBD_VENDOR_CfgFSDesc;
+}
+
+/**
+  * @brief  USBD_VENDOR_StartTx
+  *         Send the active frame buffer
+  * @param  pdev: device instance
+  * @param  hvnd: vendor handle
+  * @retval None
+  */
+static void USBD_VENDOR_StartTx(USBD_HandleTypeDef *pdev,
+                                USBD_VENDOR_HandleTypeDef *hvnd)
+{
+  uint16_t len = hvnd->tx_len[hvnd->tx_active];
+
+  hvnd->tx_busy = 1U;
+  hvnd->tx_zlp = ((len % VENDOR_DATA_FS_MAX_PACKET_SIZE) == 0U) ? 1U : 0U;
+  USBD_LL_Transmit(pdev, VENDOR_EPIN_ADDR, hvnd->tx_frame[hvnd->tx_active], len);
+}
+
+/**
+  * @brief  USBD_VENDOR_SendFrame
+  *         Send a frame on the IN endpoint, or queue it in the second
+  *         buffer when a frame is already in flight
+  * @param  pdev: device instance
+  * @param  cmd: command
+  * @param  seq: sequence number
+  * @param  status: status byte
+  * @param  payload: frame payload
+  * @param  len: payload length
+  * @retval USBD_OK, USBD_BUSY when both buffers are in use
+  */
+uint8_t USBD_VENDOR_SendFrame(USBD_HandleTypeDef *pdev, uint8_t cmd, uint8_t seq,
+                              uint8_t status, const uint8_t *payload, uint16_t len)
+{
+  USBD_VENDOR_HandleTypeDef *hvnd = &hvendor;
+  uint32_t primask;
+  uint8_t *frame;
+  uint8_t ret = USBD_OK;
+
+  if ((pdev->dev_state != USBD_STATE_CONFIGURED) || (hvendor_open == 0U) ||
+      (len > VENDOR_FRAME_MAX_PAYLOAD))
+  {
+    return USBD_FAIL;
+  }
+
+  /* DataIn runs from the USB interrupt */
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if ((hvnd->tx_busy != 0U) && (hvnd->tx_pending != 0U))
+  {
+    ret = USBD_BUSY;
+  }
+  else
+  {
+    frame = hvnd->tx_frame[(hvnd->tx_busy != 0U) ? (hvnd->tx_active ^ 1U) : hvnd->tx_active];
+    frame[0] = VENDOR_FRAME_SYNC;
+    frame[1] = cmd;
+    frame[2] = seq;
+    frame[3] = status;
+    frame[4] = LOBYTE(len);
+    frame[5] = HIBYTE(len);
+    if (len != 0U)
+    {
+      memcpy(&frame[VENDOR_FRAME_HEADER_SIZE], payload, len);
+    }
+
+    if (hvnd->tx_busy != 0U)
+    {
+      hvnd->tx_len[hvnd->tx_active ^ 1U] = VENDOR_FRAME_HEADER_SIZE + len;
+      hvnd->tx_pending = 1U;
+    }
+    else
+    {
+      hvnd->tx_len[hvnd->tx_active] = VENDOR_FRAME_HEADER_SIZE + len;
+      USBD_VENDOR_StartTx(pdev, hvnd);
+    }
+  }
+
+  __set_PRIMASK(primask);
+
+  return ret;
+}
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
+
+
+/**
+  * @}
+  */
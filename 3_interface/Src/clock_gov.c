@@ -0,0 +1,235 @@
+/**
+  ******************************************************************************
+  * @file           : clock_gov.c
+  * @brief          : Bus clock governor.
+  *
+  *                   SYSCLK stays on the 48 MHz PLL because the USB clock is
+  *                   taken from it. When no report has been exchanged for
+  *                   CLOCK_GOV_IDLE_TIMEOUT_MS (or the bus is suspended) the
+  *                   AHB prescaler is raised to 4. APB1 stays at 12 MHz so
+  *                   the USB peripheral keeps a bus clock above 8 MHz. Any
+  *                   report traffic brings the full clock back.
+  *
+  *                   Interrupts only record activity and post EVENT_CLOCK;
+  *                   the prescalers are changed from the main loop, and
+  *                   HAL_RCC_ClockConfig reloads SysTick for the new HCLK.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "clock_gov.h"
+#include "event.h"
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t gov_countdown = CLOCK_GOV_IDLE_TIMEOUT_MS;
+static volatile uint32_t gov_hold;
+
+static ClockGov_StateTypeDef gov_state = CLOCK_GOV_FULL;
+static uint32_t gov_state_since;
+static ClockGov_StatsTypeDef gov_stats;
+
+/* Private function prototypes -----------------------------------------------*/
+static void ClockGov_Switch(ClockGov_StateTypeDef state);
+static void ClockGov_Account(void);
+
+/* Private user code ---------------------------------------------------------*/
+
+/**
+  * @brief  Start the cycle counter used to time the transitions and the
+  *         residency accounting. SystemClock_Config must have run.
+  * @retval None
+  */
+void ClockGov_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  gov_state = CLOCK_GOV_FULL;
+  gov_state_since = HAL_GetTick();
+  gov_stats.entries[CLOCK_GOV_FULL] = 1U;
+
+  Event_Register(EVENT_CLOCK, ClockGov_Process);
+}
+
+/**
+  * @brief  Report traffic seen, restart the idle timeout. Interrupt safe.
+  * @retval None
+  */
+void ClockGov_Activity(void)
+{
+  gov_countdown = CLOCK_GOV_IDLE_TIMEOUT_MS;
+  if (gov_state != CLOCK_GOV_FULL)
+  {
+    Event_Post(EVENT_CLOCK);
+  }
+}
+
+/**
+  * @brief  Bus suspended, lower the clocks without waiting for the timeout.
+  * @retval None
+  */
+void ClockGov_Suspend(void)
+{
+  gov_countdown = 0U;
+  Event_Post(EVENT_CLOCK);
+}
+
+/**
+  * @brief  Keep the full clock until the matching ClockGov_Release.
+  * @param  reason: CLOCK_GOV_HOLD_xxx
+  * @retval None
+  */
+void ClockGov_Hold(uint32_t reason)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  gov_hold |= reason;
+  __set_PRIMASK(primask);
+
+  if (gov_state != CLOCK_GOV_FULL)
+  {
+    Event_Post(EVENT_CLOCK);
+  }
+}
+
+/**
+  * @brief  Drop a hold taken with ClockGov_Hold.
+  * @param  reason: CLOCK_GOV_HOLD_xxx
+  * @retval None
+  */
+void ClockGov_Release(uint32_t reason)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  gov_hold &= ~reason;
+  __set_PRIMASK(primask);
+
+  if ((gov_hold == 0U) && (gov_countdown == 0U))
+  {
+    Event_Post(EVENT_CLOCK);
+  }
+}
+
+/**
+  * @brief  1 ms tick, posts EVENT_CLOCK when the idle timeout expires.
+  * @retval None
+  */
+void ClockGov_Tick(void)
+{
+  if (gov_countdown != 0U)
+  {
+    gov_countdown--;
+    if (gov_countdown == 0U)
+    {
+      Event_Post(EVENT_CLOCK);
+    }
+  }
+}
+
+/**
+  * @brief  EVENT_CLOCK handler, applies the state matching the current
+  *         activity and holds.
+  * @retval None
+  */
+void ClockGov_Process(void)
+{
+  ClockGov_StateTypeDef state = CLOCK_GOV_FULL;
+
+  if ((gov_countdown == 0U) && (gov_hold == 0U))
+  {
+    state = CLOCK_GOV_IDLE;
+  }
+
+  if (state != gov_state)
+  {
+    ClockGov_Switch(state);
+  }
+}
+
+/**
+  * @brief  Current clock state.
+  * @retval CLOCK_GOV_FULL or CLOCK_GOV_IDLE
+  */
+ClockGov_StateTypeDef ClockGov_GetState(void)
+{
+  return gov_state;
+}
+
+/**
+  * @brief  Copy the transition and residency counters, the current state
+  *         is accounted up to now.
+  * @param  stats: destination
+  * @retval None
+  */
+void ClockGov_GetStats(ClockGov_StatsTypeDef *stats)
+{
+  ClockGov_Account();
+  *stats = gov_stats;
+}
+
+/**
+  * @brief  Program the AHB / APB prescalers of a state and time it.
+  *         Flash latency stays at 1 wait state: on this family it follows
+  *         SYSCLK, which does not change.
+  * @param  state: target state
+  * @retval None
+  */
+static void ClockGov_Switch(ClockGov_StateTypeDef state)
+{
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+  uint32_t start;
+  uint32_t cycles;
+
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  if (state == CLOCK_GOV_FULL)
+  {
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+  }
+  else
+  {
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV4;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+  }
+
+  ClockGov_Account();
+
+  start = DWT->CYCCNT;
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  cycles = DWT->CYCCNT - start;
+
+  gov_state = state;
+  gov_stats.entries[state]++;
+  gov_stats.last_cycles = cycles;
+  if (cycles > gov_stats.max_cycles)
+  {
+    gov_stats.max_cycles = cycles;
+  }
+}
+
+/**
+  * @brief  Add the time spent in the current state since the last call.
+  * @retval None
+  */
+static void ClockGov_Account(void)
+{
+  uint32_t now = HAL_GetTick();
+  uint32_t elapsed = now - gov_state_since;
+
+  gov_state_since = now;
+  gov_stats.residency_ms[gov_state] += elapsed;
+
+  if (gov_state == CLOCK_GOV_IDLE)
+  {
+    gov_stats.saved_uAs += (uint32_t)(((uint64_t)elapsed *
+                            (CLOCK_GOV_FULL_UA - CLOCK_GOV_IDLE_UA)) / 1000U);
+  }
+}
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : event.c
+  * @brief          : Cooperative main loop.
+  *
+  *                   Interrupt handlers only record that work is pending by
+  *                   setting a bit in event_pending. Event_Dispatch takes the
+  *                   whole bitmap at once and runs the handlers from bit 0
+  *                   upwards, so the order between sources does not depend
+  *                   on interrupt timing. With nothing pending the core is
+  *                   put to sleep until the next interrupt.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "event.h"
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t event_pending;
+static Event_HandlerTypeDef event_handlers[EVENT_NB];
+
+/* Private user code ---------------------------------------------------------*/
+
+/**
+  * @brief  Attach the handler run from the main loop for an event.
+  * @param  event: EVENT_xxx
+  * @param  handler: function to call, NULL to ignore the event
+  * @retval None
+  */
+void Event_Register(uint32_t event, Event_HandlerTypeDef handler)
+{
+  if (event < EVENT_NB)
+  {
+    event_handlers[event] = handler;
+  }
+}
+
+/**
+  * @brief  Mark an event pending. Safe from any interrupt priority, the
+  *         bitmap is updated with an exclusive load / store pair.
+  * @param  event: EVENT_xxx
+  * @retval None
+  */
+void Event_Post(uint32_t event)
+{
+  uint32_t pending;
+
+  if (event >= EVENT_NB)
+  {
+    return;
+  }
+
+  do
+  {
+    pending = __LDREXW(&event_pending);
+  } while (__STREXW(pending | (1UL << event), &event_pending) != 0U);
+}
+
+/**
+  * @brief  Run the handlers of every pending event, or sleep until an
+  *         interrupt when there is none. To be called from the main loop.
+  * @retval None
+  */
+void Event_Dispatch(void)
+{
+  uint32_t pending;
+  uint32_t event;
+
+  /* Interrupts stay masked between the test and WFI, so a post made right
+     after the test still wakes the core: WFI returns on a pending interrupt
+     even with PRIMASK set, and it is taken once interrupts are enabled. */
+  __disable_irq();
+  pending = event_pending;
+  if (pending == 0U)
+  {
+    __WFI();
+    __enable_irq();
+    return;
+  }
+  event_pending = 0U;
+  __enable_irq();
+
+  for (event = 0U; pending != 0U; event++, pending >>= 1)
+  {
+    if (((pending & 1U) != 0U) && (event_handlers[event] != NULL))
+    {
+      event_handlers[event]();
+    }
+  }
+}
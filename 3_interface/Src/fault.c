@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file           : fault.c
+  * @brief          : Fault capture.
+  *
+  *                   The HardFault, MemManage, BusFault and UsageFault
+  *                   handlers are defined here instead of stm32f1xx_it.c
+  *                   (handler generation disabled for them) because the
+  *                   exception frame has to be located before any C code
+  *                   touches the stack. The frame, the fault status
+  *                   registers and a few stack words are written to a
+  *                   record outside the linker RAM region, then the core is
+  *                   reset. After reboot the record is read page by page
+  *                   through the vendor feature report.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "fault.h"
+#include "watchdog.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FAULT_MAGIC                      0xFA17C0DEU
+#define FAULT_RECORD                     ((Fault_RecordTypeDef *)FAULT_RECORD_ADDR)
+#define FAULT_RECORD_WORDS               ((sizeof(Fault_RecordTypeDef) / 4U) - 1U)
+#define FAULT_PAGES_NB                   ((sizeof(Fault_RecordTypeDef) + FAULT_PAGE_SIZE - 1U) / FAULT_PAGE_SIZE)
+
+#define FAULT_RAM_START                  SRAM_BASE
+#define FAULT_RAM_END                    FAULT_RECORD_ADDR
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t fault_page;
+
+/* Private function prototypes -----------------------------------------------*/
+void Fault_Capture(uint32_t type, uint32_t *frame, uint32_t exc_return);
+static uint32_t Fault_Sum(const Fault_RecordTypeDef *record);
+static uint8_t Fault_IsValid(void);
+
+/* Exception entries ---------------------------------------------------------*/
+/* r0 = fault type, r1 = stack holding the exception frame, r2 = EXC_RETURN */
+#if defined(__CC_ARM)
+__asm static void Fault_Entry(void)
+{
+  TST     lr, #4
+  ITE     EQ
+  MRSEQ   r1, MSP
+  MRSNE   r1, PSP
+  MOV     r2, lr
+  B       __cpp(Fault_Capture)
+}
+
+__asm void HardFault_Handler(void)
+{
+  MOVS    r0, #1                       ; FAULT_TYPE_HARD
+  B       __cpp(Fault_Entry)
+}
+
+__asm void MemManage_Handler(void)
+{
+  MOVS    r0, #2                       ; FAULT_TYPE_MEMMANAGE
+  B       __cpp(Fault_Entry)
+}
+
+__asm void BusFault_Handler(void)
+{
+  MOVS    r0, #3                       ; FAULT_TYPE_BUS
+  B       __cpp(Fault_Entry)
+}
+
+__asm void UsageFault_Handler(void)
+{
+  MOVS    r0, #4                       ; FAULT_TYPE_USAGE
+  B       __cpp(Fault_Entry)
+}
+#else
+#define FAULT_STR(x)                     #x
+#define FAULT_XSTR(x)                    FAULT_STR(x)
+#define FAULT_ENTRY(type)                                                      \
+  __asm volatile ("tst   lr, #4          \n"                                   \
+                  "ite   eq              \n"                                   \
+                  "mrseq r1, msp         \n"                                   \
+                  "mrsne r1, psp         \n"                                   \
+                  "mov   r2, lr          \n"                                   \
+                  "movs  r0, #" FAULT_XSTR(type) "\n"                          \
+                  "b     Fault_Capture   \n")
+
+/* Type numbers as FAULT_TYPE_xxx, without the U suffix the assembler rejects */
+__attribute__((naked)) void HardFault_Handler(void)  { FAULT_ENTRY(1); }
+__attribute__((naked)) void MemManage_Handler(void)  { FAULT_ENTRY(2); }
+__attribute__((naked)) void BusFault_Handler(void)   { FAULT_ENTRY(3); }
+__attribute__((naked)) void UsageFault_Handler(void) { FAULT_ENTRY(4); }
+#endif
+
+/* Private user code ---------------------------------------------------------*/
+
+/**
+  * @brief  Drop a record left by a power cycle and route the configurable
+  *         faults to their own handlers instead of HardFault.
+  * @retval None
+  */
+void Fault_Init(void)
+{
+  if (Fault_IsValid() == 0U)
+  {
+    memset(FAULT_RECORD, 0, sizeof(Fault_RecordTypeDef));
+  }
+
+  SCB->SHCSR |= SCB_SHCSR_USGFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk |
+                SCB_SHCSR_MEMFAULTENA_Msk;
+}
+
+/**
+  * @brief  Fill the record from the exception frame and reset.
+  *         Runs in handler mode on whatever stack is left, uses no more
+  *         than a few words of it.
+  * @param  type: FAULT_TYPE_xxx
+  * @param  frame: exception frame pushed by the core
+  * @param  exc_return: LR value on exception entry
+  * @retval None
+  */
+void Fault_Capture(uint32_t type, uint32_t *frame, uint32_t exc_return)
+{
+  Fault_RecordTypeDef *record = FAULT_RECORD;
+  uint32_t addr = (uint32_t)frame;
+  uint32_t i;
+
+  record->count = (Fault_IsValid() != 0U) ? (record->count + 1U) : 1U;
+  record->magic = FAULT_MAGIC;
+  record->type = type;
+  record->exc_return = exc_return;
+  record->cfsr = SCB->CFSR;
+  record->hfsr = SCB->HFSR;
+  record->mmfar = SCB->MMFAR;
+  record->bfar = SCB->BFAR;
+
+  /* A stack overflow may leave the frame outside RAM, reading it would
+     lock the core up */
+  if ((addr >= FAULT_RAM_START) && (addr <= (FAULT_RAM_END - (8U * 4U))) &&
+      ((addr & 3U) == 0U))
+  {
+    record->r0 = frame[0];
+    record->r1 = frame[1];
+    record->r2 = frame[2];
+    record->r3 = frame[3];
+    record->r12 = frame[4];
+    record->lr = frame[5];
+    record->pc = frame[6];
+    record->xpsr = frame[7];
+
+    addr += 8U * 4U;
+    if ((record->xpsr & (1UL << 9)) != 0U)
+    {
+      /* Stack was realigned to 8 bytes on entry */
+      addr += 4U;
+    }
+    record->sp = addr;
+
+    for (i = 0U; i < 8U; i++, addr += 4U)
+    {
+      record->stack[i] = (addr < FAULT_RAM_END) ? *(uint32_t *)addr : 0U;
+    }
+  }
+  else
+  {
+    record->r0 = record->r1 = record->r2 = record->r3 = 0U;
+    record->r12 = record->lr = record->pc = record->xpsr = 0U;
+    record->sp = addr;
+    memset(record->stack, 0, sizeof(record->stack));
+  }
+
+  record->sum = Fault_Sum(record);
+
+  NVIC_SystemReset();
+}
+
+/**
+  * @brief  Handle a SET_FEATURE of the vendor report: page select or clear.
+  * @param  report: report data, report ID first
+  * @param  len: report length
+  * @retval None
+  */
+void Fault_SetFeatureReport(const uint8_t *report, uint16_t len)
+{
+  if ((len < 3U) || (report[0] != FAULT_REPORT_ID))
+  {
+    return;
+  }
+
+  if (report[2] == FAULT_CMD_CLEAR)
+  {
+    memset(FAULT_RECORD, 0, sizeof(Fault_RecordTypeDef));
+    fault_page = 0U;
+    return;
+  }
+
+  fault_page = (report[1] < FAULT_PAGES_NB) ? report[1] : 0U;
+}
+
+/**
+  * @brief  Build the vendor feature report with the selected record page.
+  *         The page count is 0 when no fault is recorded.
+  * @param  report: destination buffer, FAULT_REPORT_SIZE bytes
+  * @retval report length
+  */
+uint16_t Fault_GetFeatureReport(uint8_t *report)
+{
+  uint32_t offset = (uint32_t)fault_page * FAULT_PAGE_SIZE;
+  uint32_t count = 0U;
+
+  memset(report, 0, FAULT_REPORT_SIZE);
+  report[0] = FAULT_REPORT_ID;
+  report[1] = fault_page;
+  report[3] = (uint8_t)Watchdog_GetResetCause();
+
+  if (Fault_IsValid() != 0U)
+  {
+    report[2] = FAULT_PAGES_NB;
+    count = sizeof(Fault_RecordTypeDef) - offset;
+    if (count > FAULT_PAGE_SIZE)
+    {
+      count = FAULT_PAGE_SIZE;
+    }
+    memcpy(&report[4], (const uint8_t *)FAULT_RECORD + offset, count);
+  }
+
+  return FAULT_REPORT_SIZE;
+}
+
+/**
+  * @brief  Give access to the record of the last fault.
+  * @retval record, NULL when no fault is recorded
+  */
+const Fault_RecordTypeDef *Fault_GetRecord(void)
+{
+  return (Fault_IsValid() != 0U) ? FAULT_RECORD : NULL;
+}
+
+/**
+  * @brief  Sum of the record words, sum field excluded.
+  * @param  record: record to check
+  * @retval sum
+  */
+static uint32_t Fault_Sum(const Fault_RecordTypeDef *record)
+{
+  const uint32_t *word = (const uint32_t *)record;
+  uint32_t sum = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < FAULT_RECORD_WORDS; i++)
+  {
+    sum += word[i];
+  }
+  return sum;
+}
+
+/**
+  * @brief  Check that the RAM record was written by Fault_Capture.
+  * @retval 1 if valid, 0 otherwise
+  */
+static uint8_t Fault_IsValid(void)
+{
+  return ((FAULT_RECORD->magic == FAULT_MAGIC) &&
+          (FAULT_RECORD->sum == Fault_Sum(FAULT_RECORD))) ? 1U : 0U;
+}
@@ -0,0 +1,380 @@
+/**
+  ******************************************************************************
+  * @file           : haptic.c
+  * @brief          : Surface Dial haptic feedback.
+  *
+  *                   The envelope of every waveform is computed once at init
+  *                   into a table of TIM1 compare values. Playing a waveform
+  *                   only arms DMA1 channel 5 (TIM1_UP) on that table, so the
+  *                   samples are streamed into CCR1 without CPU work. TIM1
+  *                   runs a 24 kHz carrier and its repetition counter makes
+  *                   the update (and the DMA request) fire at
+  *                   HAPTIC_SAMPLE_RATE_HZ.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "haptic.h"
+#include "event.h"
+#include "clock_gov.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint16_t duration_ms;   /* length of the waveform */
+  uint8_t  level;         /* duty cycle in percent */
+  uint8_t  alt_level;     /* duty cycle of the modulated half periods */
+  uint8_t  half_period_ms;/* modulation half period, 0 for a flat envelope */
+} Haptic_ShapeTypeDef;
+
+typedef struct
+{
+  uint16_t offset;        /* first sample in haptic_samples */
+  uint16_t length;        /* number of samples, trailing 0 duty included */
+} Haptic_SlotTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define HAPTIC_MS_TO_SAMPLES(ms)   ((uint32_t)(ms) * HAPTIC_SAMPLE_RATE_HZ / 1000U)
+
+#define HAPTIC_CLICK_MS            10U
+#define HAPTIC_BUZZ_MS             100U
+#define HAPTIC_RUMBLE_MS           150U
+#define HAPTIC_PRESS_MS            15U
+#define HAPTIC_RELEASE_MS          8U
+
+#define HAPTIC_SHAPES_NB           (HAPTIC_WAVEFORM_RELEASE - HAPTIC_WAVEFORM_CLICK + 1U)
+#define HAPTIC_SAMPLES_NB          (HAPTIC_MS_TO_SAMPLES(HAPTIC_CLICK_MS + HAPTIC_BUZZ_MS + \
+                                    HAPTIC_RUMBLE_MS + HAPTIC_PRESS_MS + HAPTIC_RELEASE_MS) + \
+                                    HAPTIC_SHAPES_NB)
+
+/* Private variables ---------------------------------------------------------*/
+static const Haptic_ShapeTypeDef haptic_shapes[HAPTIC_SHAPES_NB] =
+{
+  { HAPTIC_CLICK_MS,   100U,  0U,  0U },   /* CLICK   */
+  { HAPTIC_BUZZ_MS,     60U,  0U,  0U },   /* BUZZ    */
+  { HAPTIC_RUMBLE_MS,   80U, 30U, 20U },   /* RUMBLE  */
+  { HAPTIC_PRESS_MS,    80U,  0U,  0U },   /* PRESS   */
+  { HAPTIC_RELEASE_MS,  50U,  0U,  0U },   /* RELEASE */
+};
+
+static uint16_t haptic_samples[HAPTIC_SAMPLES_NB];
+static Haptic_SlotTypeDef haptic_slots[HAPTIC_SHAPES_NB];
+
+static TIM_HandleTypeDef *haptic_tim;
+
+/* Host controlled parameters (feature report) */
+static uint8_t  haptic_repeat_count;
+static uint8_t  haptic_auto_trigger = HAPTIC_WAVEFORM_CLICK;
+static uint8_t  haptic_cutoff_time;
+static uint16_t haptic_retrigger_period;
+
+/* Playback state */
+static volatile uint8_t  haptic_waveform;
+static volatile uint8_t  haptic_repeat_left;
+static volatile uint16_t haptic_retrigger;
+static volatile uint16_t haptic_countdown;
+static volatile uint8_t  haptic_due;
+static volatile uint8_t  haptic_busy;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Haptic_Build(void);
+static void Haptic_Start(uint8_t waveform);
+static void Haptic_Halt(void);
+static void Haptic_DmaCplt(DMA_HandleTypeDef *hdma);
+
+/* Private user code ---------------------------------------------------------*/
+
+/**
+  * @brief  Precompute the waveform table and start the PWM output at 0 duty.
+  * @param  htim: timer handle, channel 1 drives the actuator, its update DMA
+  *               request must be linked to hdma[TIM_DMA_ID_UPDATE]
+  * @retval None
+  */
+void Haptic_Init(TIM_HandleTypeDef *htim)
+{
+  haptic_tim = htim;
+
+  Haptic_Build();
+
+  htim->hdma[TIM_DMA_ID_UPDATE]->XferCpltCallback = Haptic_DmaCplt;
+  Event_Register(EVENT_HAPTIC, Haptic_Process);
+  __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_1, 0U);
+
+  if (HAL_TIM_PWM_Start(htim, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief  Play a waveform now, then repeat it every retrigger_ms.
+  * @param  waveform: HAPTIC_WAVEFORM_xxx
+  * @param  repeat: number of additional plays
+  * @param  retrigger_ms: delay between the start of two plays
+  * @retval None
+  */
+void Haptic_Play(uint8_t waveform, uint8_t repeat, uint16_t retrigger_ms)
+{
+  uint32_t primask;
+
+  if ((haptic_tim == NULL) || (waveform == HAPTIC_WAVEFORM_NONE) ||
+      (waveform == HAPTIC_WAVEFORM_NULL) || (waveform > HAPTIC_WAVEFORM_RELEASE))
+  {
+    return;
+  }
+
+  /* May be called from the main loop, keep the DMA callback and the tick
+     out while the playback state changes */
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  haptic_countdown = 0U;
+  haptic_due = 0U;
+
+  if (waveform == HAPTIC_WAVEFORM_STOP)
+  {
+    haptic_repeat_left = 0U;
+    Haptic_Halt();
+  }
+  else
+  {
+    haptic_repeat_left = repeat;
+    haptic_retrigger = retrigger_ms;
+    Haptic_Start(waveform);
+  }
+
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Play the waveform selected by the host for automatic feedback,
+  *         to be called by the dial on each detent.
+  * @retval None
+  */
+void Haptic_AutoTrigger(void)
+{
+  Haptic_Play(haptic_auto_trigger, 0U, 0U);
+}
+
+/**
+  * @brief  1 ms tick, posts EVENT_HAPTIC once the retrigger period of a
+  *         repeated waveform has elapsed.
+  * @retval None
+  */
+void Haptic_Tick(void)
+{
+  if (haptic_countdown != 0U)
+  {
+    haptic_countdown--;
+    if (haptic_countdown == 0U)
+    {
+      haptic_due = 1U;
+      Event_Post(EVENT_HAPTIC);
+    }
+  }
+}
+
+/**
+  * @brief  EVENT_HAPTIC handler, restarts the waveform due for repetition.
+  * @retval None
+  */
+void Haptic_Process(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if ((haptic_due != 0U) && (haptic_busy == 0U))
+  {
+    haptic_due = 0U;
+    Haptic_Start(haptic_waveform);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Parse an output report of the dial interface and trigger it.
+  * @param  report: report data, report ID first
+  * @param  len: report length
+  * @retval None
+  */
+void Haptic_OutputReport(const uint8_t *report, uint16_t len)
+{
+  uint16_t retrigger;
+
+  if ((len < HAPTIC_OUTPUT_REPORT_SIZE) || (report[0] != HAPTIC_REPORT_ID))
+  {
+    return;
+  }
+
+  retrigger = (uint16_t)report[3] | ((uint16_t)report[4] << 8);
+
+  if (retrigger > HAPTIC_RETRIGGER_MAX_MS)
+  {
+    retrigger = HAPTIC_RETRIGGER_MAX_MS;
+  }
+
+  Haptic_Play(report[2], report[1], retrigger);
+}
+
+/**
+  * @brief  Update the haptic parameters from a feature report.
+  * @param  report: report data, report ID first
+  * @param  len: report length
+  * @retval None
+  */
+void Haptic_SetFeatureReport(const uint8_t *report, uint16_t len)
+{
+  uint16_t retrigger;
+
+  if ((len < HAPTIC_FEATURE_REPORT_SIZE) || (report[0] != HAPTIC_REPORT_ID))
+  {
+    return;
+  }
+
+  haptic_repeat_count = report[3];
+
+  if ((report[4] >= HAPTIC_WAVEFORM_STOP) && (report[4] <= HAPTIC_WAVEFORM_RELEASE))
+  {
+    haptic_auto_trigger = report[4];
+  }
+
+  if (report[5] <= HAPTIC_CUTOFF_MAX)
+  {
+    haptic_cutoff_time = report[5];
+  }
+
+  retrigger = (uint16_t)report[6] | ((uint16_t)report[7] << 8);
+  if (retrigger <= HAPTIC_RETRIGGER_MAX_MS)
+  {
+    haptic_retrigger_period = retrigger;
+  }
+}
+
+/**
+  * @brief  Build the feature report of the dial interface.
+  * @param  report: destination buffer, HAPTIC_FEATURE_REPORT_SIZE bytes
+  * @retval report length
+  */
+uint16_t Haptic_GetFeatureReport(uint8_t *report)
+{
+  report[0] = HAPTIC_REPORT_ID;
+  report[1] = (uint8_t)(HAPTIC_DIAL_RESOLUTION & 0xFFU);
+  report[2] = (uint8_t)(HAPTIC_DIAL_RESOLUTION >> 8);
+  report[3] = haptic_repeat_count;
+  report[4] = haptic_auto_trigger;
+  report[5] = haptic_cutoff_time;
+  report[6] = (uint8_t)(haptic_retrigger_period & 0xFFU);
+  report[7] = (uint8_t)(haptic_retrigger_period >> 8);
+
+  return HAPTIC_FEATURE_REPORT_SIZE;
+}
+
+/**
+  * @brief  Fill haptic_samples with the compare values of every waveform.
+  *         Each waveform ends with a 0 duty sample so the actuator is left
+  *         off when the DMA transfer completes.
+  * @retval None
+  */
+static void Haptic_Build(void)
+{
+  uint32_t period = __HAL_TIM_GET_AUTORELOAD(haptic_tim) + 1U;
+  uint16_t offset = 0U;
+  uint32_t shape;
+  uint32_t i;
+
+  for (shape = 0U; shape < HAPTIC_SHAPES_NB; shape++)
+  {
+    const Haptic_ShapeTypeDef *s = &haptic_shapes[shape];
+    uint32_t length = HAPTIC_MS_TO_SAMPLES(s->duration_ms);
+    uint32_t half = HAPTIC_MS_TO_SAMPLES(s->half_period_ms);
+
+    haptic_slots[shape].offset = offset;
+    haptic_slots[shape].length = (uint16_t)(length + 1U);
+
+    for (i = 0U; i < length; i++)
+    {
+      uint32_t level = s->level;
+
+      if ((half != 0U) && (((i / half) & 1U) != 0U))
+      {
+        level = s->alt_level;
+      }
+      haptic_samples[offset++] = (uint16_t)((period * level) / 100U);
+    }
+    haptic_samples[offset++] = 0U;
+  }
+}
+
+/**
+  * @brief  Arm the update DMA on the samples of a waveform.
+  * @param  waveform: HAPTIC_WAVEFORM_CLICK .. HAPTIC_WAVEFORM_RELEASE
+  * @retval None
+  */
+static void Haptic_Start(uint8_t waveform)
+{
+  const Haptic_SlotTypeDef *slot = &haptic_slots[waveform - HAPTIC_WAVEFORM_CLICK];
+  DMA_HandleTypeDef *hdma = haptic_tim->hdma[TIM_DMA_ID_UPDATE];
+
+  if (haptic_busy != 0U)
+  {
+    Haptic_Halt();
+  }
+
+  haptic_waveform = waveform;
+  haptic_busy = 1U;
+  ClockGov_Hold(CLOCK_GOV_HOLD_HAPTIC);
+
+  if (HAL_DMA_Start_IT(hdma, (uint32_t)&haptic_samples[slot->offset],
+                       (uint32_t)&haptic_tim->Instance->CCR1, slot->length) != HAL_OK)
+  {
+    haptic_busy = 0U;
+    ClockGov_Release(CLOCK_GOV_HOLD_HAPTIC);
+    return;
+  }
+  __HAL_TIM_ENABLE_DMA(haptic_tim, TIM_DMA_UPDATE);
+}
+
+/**
+  * @brief  Stop the current waveform and switch the actuator off.
+  * @retval None
+  */
+static void Haptic_Halt(void)
+{
+  __HAL_TIM_DISABLE_DMA(haptic_tim, TIM_DMA_UPDATE);
+  HAL_DMA_Abort(haptic_tim->hdma[TIM_DMA_ID_UPDATE]);
+  __HAL_TIM_SET_COMPARE(haptic_tim, TIM_CHANNEL_1, 0U);
+  haptic_busy = 0U;
+  ClockGov_Release(CLOCK_GOV_HOLD_HAPTIC);
+}
+
+/**
+  * @brief  End of a waveform, schedule the next repetition if any.
+  * @param  hdma: DMA handle
+  * @retval None
+  */
+static void Haptic_DmaCplt(DMA_HandleTypeDef *hdma)
+{
+  uint32_t played_ms;
+
+  UNUSED(hdma);
+  __HAL_TIM_DISABLE_DMA(haptic_tim, TIM_DMA_UPDATE);
+  haptic_busy = 0U;
+
+  if (haptic_repeat_left == 0U)
+  {
+    ClockGov_Release(CLOCK_GOV_HOLD_HAPTIC);
+    return;
+  }
+  haptic_repeat_left--;
+
+  /* The retrigger period runs from the start of the previous play */
+  played_ms = haptic_shapes[haptic_waveform - HAPTIC_WAVEFORM_CLICK].duration_ms;
+  if (haptic_retrigger > played_ms)
+  {
+    haptic_countdown = (uint16_t)(haptic_retrigger - played_ms);
+  }
+  else
+  {
+    Haptic_Start(haptic_waveform);
+  }
+}
@@ -24,7 +24,13 @@
 #include "usb_device.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
+#include "usbd_composite.h"
 #include "usbd_hid.h"
+#include "usbd_hid_if.h"
+#include "usbd_vendor.h"
+#include "usbd_vendor_if.h"
+#include "usbd_dfu.h"
+#include "usbd_dfu_if.h"
 
 /* USER CODE BEGIN Includes */
 
@@ -72,7 +78,23 @@ void MX_USB_DEVICE_Init(void)
   {
     Error_Handler();
   }
-  if (USBD_RegisterClass(&hUsbDeviceFS, &USBD_HID) != USBD_OK)
+  if (USBD_COMPOSITE_AddClass(&hUsbDeviceFS, &USBD_HID, NULL) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_COMPOSITE_AddClass(&hUsbDeviceFS, &USBD_VENDOR, &USBD_VENDOR_fops_FS) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_COMPOSITE_AddClass(&hUsbDeviceFS, &USBD_DFU, &USBD_DFU_fops_FS) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_RegisterClass(&hUsbDeviceFS, &USBD_COMPOSITE) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_HID_RegisterInterface(&hUsbDeviceFS, &USBD_HID_fops_FS) != USBD_OK)
   {
     Error_Handler();
   }
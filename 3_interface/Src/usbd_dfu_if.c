@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_dfu_if.c
+  * @brief          : Flash download slot behind the DFU interface.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_dfu_if.h"
+#include "event.h"
+#include "clock_gov.h"
+
+/* Private variables ---------------------------------------------------------*/
+extern USBD_HandleTypeDef hUsbDeviceFS;
+extern CRC_HandleTypeDef hcrc;
+
+/* Download in progress: bytes erased from the start of the slot, end of
+   the last chunk programmed, record page erased */
+static uint32_t dfu_erased;
+static uint32_t dfu_next;
+static uint8_t dfu_record_erased;
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t DFU_Init_FS(void);
+static int8_t DFU_DeInit_FS(void);
+static int8_t DFU_Write_FS(uint32_t offset, const uint8_t *buf, uint32_t len);
+static int8_t DFU_Verify_FS(uint32_t offset, const uint8_t *buf, uint32_t len);
+static uint32_t DFU_Read_FS(uint32_t offset, uint8_t *buf, uint32_t len);
+static int8_t DFU_Manifest_FS(uint32_t size);
+static void DFU_Schedule_FS(void);
+static HAL_StatusTypeDef DFU_ErasePage(uint32_t addr);
+static HAL_StatusTypeDef DFU_Program(uint32_t addr, const uint8_t *buf, uint32_t len);
+
+USBD_DFU_MediaTypeDef USBD_DFU_fops_FS =
+{
+  DFU_Init_FS,
+  DFU_DeInit_FS,
+  DFU_Write_FS,
+  DFU_Verify_FS,
+  DFU_Read_FS,
+  DFU_Manifest_FS,
+  DFU_Schedule_FS,
+  DFU_SLOT_SIZE
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Interface configured, no page is known to be erased.
+  * @retval USBD_OK
+  */
+static int8_t DFU_Init_FS(void)
+{
+  dfu_erased = 0U;
+  dfu_next = 0U;
+  dfu_record_erased = 0U;
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  Interface deconfigured.
+  * @retval USBD_OK
+  */
+static int8_t DFU_DeInit_FS(void)
+{
+  return DFU_Init_FS();
+}
+
+/**
+  * @brief  Program a chunk of the image. The record page, then the slot
+  *         pages up to DFU_ERASE_AHEAD past the chunk are erased first, one
+  *         page per call so that the main loop keeps running.
+  * @param  offset: position in the slot
+  * @param  buf: data, len is even
+  * @param  len: chunk length
+  * @retval USBD_OK, USBD_BUSY when a page was erased, USBD_FAIL
+  */
+static int8_t DFU_Write_FS(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+  uint32_t end = offset + len;
+  uint32_t target;
+
+  if ((offset == 0U) && (dfu_next != 0U))
+  {
+    /* New download over a previous one */
+    (void)DFU_Init_FS();
+  }
+
+  if (dfu_record_erased == 0U)
+  {
+    if (DFU_ErasePage(DFU_RECORD_ADDR) != HAL_OK)
+    {
+      return (int8_t)USBD_FAIL;
+    }
+    dfu_record_erased = 1U;
+    return (int8_t)USBD_BUSY;
+  }
+
+  target = MIN(end + DFU_ERASE_AHEAD, DFU_SLOT_SIZE);
+  if (dfu_erased < target)
+  {
+    if (DFU_ErasePage(DFU_SLOT_ADDR + dfu_erased) != HAL_OK)
+    {
+      return (int8_t)USBD_FAIL;
+    }
+    dfu_erased += FLASH_PAGE_SIZE;
+    return (int8_t)USBD_BUSY;
+  }
+
+  if (DFU_Program(DFU_SLOT_ADDR + offset, buf, len) != HAL_OK)
+  {
+    return (int8_t)USBD_FAIL;
+  }
+  dfu_next = end;
+
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  Compare the CRC of a programmed block with the one of its data.
+  * @param  offset: position in the slot
+  * @param  buf: block data, word aligned
+  * @param  len: block length, multiple of 4
+  * @retval USBD_OK, USBD_FAIL on mismatch
+  */
+static int8_t DFU_Verify_FS(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+  uint32_t crc_ram = HAL_CRC_Calculate(&hcrc, (uint32_t *)(void *)buf, len / 4U);
+  uint32_t crc_flash = HAL_CRC_Calculate(&hcrc, (uint32_t *)(DFU_SLOT_ADDR + offset), len / 4U);
+
+  return (crc_ram == crc_flash) ? (int8_t)USBD_OK : (int8_t)USBD_FAIL;
+}
+
+/**
+  * @brief  Copy a part of the slot for UPLOAD.
+  * @param  offset: position in the slot
+  * @param  buf: destination
+  * @param  len: length
+  * @retval length copied
+  */
+static uint32_t DFU_Read_FS(uint32_t offset, uint8_t *buf, uint32_t len)
+{
+  memcpy(buf, (const uint8_t *)(DFU_SLOT_ADDR + offset), len);
+  return len;
+}
+
+/**
+  * @brief  Image complete: write its record, the magic word last.
+  * @param  size: image size
+  * @retval USBD_OK, USBD_FAIL
+  */
+static int8_t DFU_Manifest_FS(uint32_t size)
+{
+  DFU_RecordTypeDef record;
+
+  if ((size == 0U) || (dfu_record_erased == 0U))
+  {
+    return (int8_t)USBD_FAIL;
+  }
+
+  record.magic = DFU_RECORD_MAGIC;
+  record.size = size;
+  record.crc = HAL_CRC_Calculate(&hcrc, (uint32_t *)DFU_SLOT_ADDR, size / 4U);
+  record.reserved = 0xFFFFFFFFU;
+
+  if ((DFU_Program(DFU_RECORD_ADDR + 4U, (const uint8_t *)&record + 4U,
+                   sizeof(record) - 4U) != HAL_OK) ||
+      (DFU_Program(DFU_RECORD_ADDR, (const uint8_t *)&record, 4U) != HAL_OK))
+  {
+    return (int8_t)USBD_FAIL;
+  }
+
+  (void)DFU_Init_FS();
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  Work is queued: run DFU_Process_FS from the main loop, at full
+  *         speed.
+  * @retval None
+  */
+static void DFU_Schedule_FS(void)
+{
+  ClockGov_Activity();
+  Event_Post(EVENT_DFU);
+}
+
+/**
+  * @brief  Erase one flash page.
+  * @param  addr: page address
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef DFU_ErasePage(uint32_t addr)
+{
+  FLASH_EraseInitTypeDef erase;
+  uint32_t error;
+  HAL_StatusTypeDef status;
+
+  erase.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase.Banks = FLASH_BANK_1;
+  erase.PageAddress = addr;
+  erase.NbPages = 1U;
+
+  HAL_FLASH_Unlock();
+  status = HAL_FLASHEx_Erase(&erase, &error);
+  HAL_FLASH_Lock();
+
+  return status;
+}
+
+/**
+  * @brief  Program erased flash a half-word at a time, erased half-words
+  *         of the data are skipped.
+  * @param  addr: destination, half-word aligned
+  * @param  buf: data
+  * @param  len: length, even
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef DFU_Program(uint32_t addr, const uint8_t *buf, uint32_t len)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint16_t data;
+  uint32_t i;
+
+  HAL_FLASH_Unlock();
+  for (i = 0U; (i < len) && (status == HAL_OK); i += 2U)
+  {
+    data = (uint16_t)(buf[i] | ((uint16_t)buf[i + 1U] << 8));
+    if (data != 0xFFFFU)
+    {
+      status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr + i, data);
+    }
+  }
+  HAL_FLASH_Lock();
+
+  return status;
+}
+
+/**
+  * @brief  EVENT_DFU handler, programs the next part of the download.
+  * @retval None
+  */
+void DFU_Process_FS(void)
+{
+  USBD_DFU_Process(&hUsbDeviceFS);
+}
@@ -0,0 +1,126 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_hid_if.c
+  * @brief          : SET_REPORT / GET_REPORT handling of the HID interfaces.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_hid_if.h"
+#include "haptic.h"
+#include "event.h"
+#include "clock_gov.h"
+#include "fault.h"
+
+/* Private variables ---------------------------------------------------------*/
+/* GET_REPORT data, sent from here by the EP0 data stage */
+static uint8_t hid_report_buf[HID_EP0_REPORT_BUF_SIZE];
+
+/* Last haptic output report, played from the main loop (EVENT_USB_REPORT) */
+static uint8_t hid_output_buf[HAPTIC_OUTPUT_REPORT_SIZE];
+static volatile uint16_t hid_output_len;
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t HID_SetReport_FS(uint8_t itf, uint8_t type, uint8_t id, uint8_t *report, uint16_t len);
+static uint8_t *HID_GetReport_FS(uint8_t itf, uint8_t type, uint8_t id, uint16_t *len);
+
+USBD_HID_ItfTypeDef USBD_HID_fops_FS =
+{
+  HID_SetReport_FS,
+  HID_GetReport_FS
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Handle the data of a SET_REPORT request.
+  * @param  itf: interface number
+  * @param  type: report type (HID_REPORT_TYPE_xxx)
+  * @param  id: report ID
+  * @param  report: report data, report ID first when the interface uses IDs
+  * @param  len: report length
+  * @retval USBD_OK if the report was consumed
+  */
+static int8_t HID_SetReport_FS(uint8_t itf, uint8_t type, uint8_t id, uint8_t *report, uint16_t len)
+{
+  ClockGov_Activity();
+
+  if ((itf == HID_DIAL_ITF) && (id == HAPTIC_REPORT_ID))
+  {
+    if (type == HID_REPORT_TYPE_OUTPUT)
+    {
+      /* A report still pending is superseded by the newer one */
+      if (len > sizeof(hid_output_buf))
+      {
+        len = sizeof(hid_output_buf);
+      }
+      memcpy(hid_output_buf, report, len);
+      hid_output_len = len;
+      Event_Post(EVENT_USB_REPORT);
+      return (int8_t)USBD_OK;
+    }
+    if (type == HID_REPORT_TYPE_FEATURE)
+    {
+      Haptic_SetFeatureReport(report, len);
+      return (int8_t)USBD_OK;
+    }
+  }
+
+  if ((itf == HID_MOUSE_ITF) && (id == FAULT_REPORT_ID) && (type == HID_REPORT_TYPE_FEATURE))
+  {
+    Fault_SetFeatureReport(report, len);
+    return (int8_t)USBD_OK;
+  }
+
+  return (int8_t)USBD_FAIL;
+}
+
+/**
+  * @brief  Build the data of a GET_REPORT request.
+  * @param  itf: interface number
+  * @param  type: report type (HID_REPORT_TYPE_xxx)
+  * @param  id: report ID
+  * @param  len: report length
+  * @retval pointer to the report, NULL to stall the request
+  */
+static uint8_t *HID_GetReport_FS(uint8_t itf, uint8_t type, uint8_t id, uint16_t *len)
+{
+  ClockGov_Activity();
+
+  if ((itf == HID_DIAL_ITF) && (id == HAPTIC_REPORT_ID) && (type == HID_REPORT_TYPE_FEATURE))
+  {
+    *len = Haptic_GetFeatureReport(hid_report_buf);
+    return hid_report_buf;
+  }
+
+  if ((itf == HID_MOUSE_ITF) && (id == FAULT_REPORT_ID) && (type == HID_REPORT_TYPE_FEATURE))
+  {
+    *len = Fault_GetFeatureReport(hid_report_buf);
+    return hid_report_buf;
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  EVENT_USB_REPORT handler, passes the last output report received
+  *         on the dial interface to the haptic driver.
+  * @retval None
+  */
+void HID_ProcessOutputReport_FS(void)
+{
+  uint8_t report[HAPTIC_OUTPUT_REPORT_SIZE];
+  uint16_t len;
+
+  /* The USB interrupt may overwrite the buffer with a newer report */
+  __disable_irq();
+  len = hid_output_len;
+  memcpy(report, hid_output_buf, len);
+  hid_output_len = 0U;
+  __enable_irq();
+
+  if (len != 0U)
+  {
+    Haptic_OutputReport(report, len);
+  }
+}
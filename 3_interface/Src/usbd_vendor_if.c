@@ -0,0 +1,232 @@
+/**
+  ******************************************************************************
+  * @file           : usbd_vendor_if.c
+  * @brief          : Commands and telemetry of the vendor bulk interface.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbd_vendor_if.h"
+#include "event.h"
+#include "clock_gov.h"
+#include "fault.h"
+#include "watchdog.h"
+
+/* Private variables ---------------------------------------------------------*/
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+/* Request received on the OUT endpoint, answered from the main loop
+   (EVENT_VENDOR). The host waits for the reply before the next request. */
+static uint8_t vendor_req_buf[VENDOR_FRAME_MAX_PAYLOAD];
+static uint16_t vendor_req_len;
+static uint8_t vendor_req_cmd;
+static uint8_t vendor_req_seq;
+static volatile uint8_t vendor_req_pending;
+
+/* Telemetry, one statistics frame every vendor_stream_period ms */
+static volatile uint16_t vendor_stream_period;
+static volatile uint16_t vendor_stream_count;
+static volatile uint8_t vendor_stream_due;
+static uint8_t vendor_stream_seq;
+
+/* Private function prototypes -----------------------------------------------*/
+static int8_t VENDOR_Init_FS(void);
+static int8_t VENDOR_DeInit_FS(void);
+static int8_t VENDOR_Receive_FS(uint8_t cmd, uint8_t seq, uint8_t *payload, uint16_t len);
+static void VENDOR_TxComplete_FS(void);
+static uint16_t VENDOR_GetStats(uint8_t *buf);
+
+USBD_VENDOR_ItfTypeDef USBD_VENDOR_fops_FS =
+{
+  VENDOR_Init_FS,
+  VENDOR_DeInit_FS,
+  VENDOR_Receive_FS,
+  VENDOR_TxComplete_FS
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Interface configured by the host.
+  * @retval USBD_OK
+  */
+static int8_t VENDOR_Init_FS(void)
+{
+  vendor_req_pending = 0U;
+  vendor_stream_period = 0U;
+  vendor_stream_due = 0U;
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  Interface deconfigured, telemetry stops.
+  * @retval USBD_OK
+  */
+static int8_t VENDOR_DeInit_FS(void)
+{
+  vendor_stream_period = 0U;
+  vendor_stream_due = 0U;
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  Take a complete frame received on the OUT endpoint.
+  *         Called from the USB interrupt, the frame is handled by
+  *         VENDOR_Process_FS.
+  * @param  cmd: command
+  * @param  seq: sequence number, echoed in the reply
+  * @param  payload: frame payload
+  * @param  len: payload length
+  * @retval USBD_OK, USBD_BUSY if the previous request is not answered yet
+  */
+static int8_t VENDOR_Receive_FS(uint8_t cmd, uint8_t seq, uint8_t *payload, uint16_t len)
+{
+  ClockGov_Activity();
+
+  if (vendor_req_pending != 0U)
+  {
+    return (int8_t)USBD_BUSY;
+  }
+
+  memcpy(vendor_req_buf, payload, len);
+  vendor_req_len = len;
+  vendor_req_cmd = cmd;
+  vendor_req_seq = seq;
+  vendor_req_pending = 1U;
+  Event_Post(EVENT_VENDOR);
+
+  return (int8_t)USBD_OK;
+}
+
+/**
+  * @brief  A transmit buffer is free again: retry what could not be queued.
+  * @retval None
+  */
+static void VENDOR_TxComplete_FS(void)
+{
+  if ((vendor_req_pending != 0U) || (vendor_stream_due != 0U))
+  {
+    Event_Post(EVENT_VENDOR);
+  }
+}
+
+/**
+  * @brief  Build the statistics payload: clock governor statistics followed
+  *         by the watchdog reset cause, 32-bit little endian words.
+  * @param  buf: destination buffer
+  * @retval payload length
+  */
+static uint16_t VENDOR_GetStats(uint8_t *buf)
+{
+  ClockGov_StatsTypeDef stats;
+  uint32_t cause = Watchdog_GetResetCause();
+
+  ClockGov_GetStats(&stats);
+  memcpy(buf, &stats, sizeof(stats));
+  memcpy(&buf[sizeof(stats)], &cause, sizeof(cause));
+  return (uint16_t)(sizeof(stats) + sizeof(cause));
+}
+
+/**
+  * @brief  Count down the telemetry period, called every ms from SysTick.
+  * @retval None
+  */
+void VENDOR_Tick_FS(void)
+{
+  if (vendor_stream_period == 0U)
+  {
+    return;
+  }
+
+  if (--vendor_stream_count == 0U)
+  {
+    vendor_stream_count = vendor_stream_period;
+    vendor_stream_due = 1U;
+    Event_Post(EVENT_VENDOR);
+  }
+}
+
+/**
+  * @brief  EVENT_VENDOR handler: answer the pending request and send the
+  *         telemetry frame that is due. A frame that does not fit in the
+  *         transmit buffers is kept for the next TxComplete.
+  * @retval None
+  */
+void VENDOR_Process_FS(void)
+{
+  uint8_t reply[VENDOR_FRAME_MAX_PAYLOAD];
+  const Fault_RecordTypeDef *record;
+  uint16_t len = 0U;
+  uint16_t period;
+  uint8_t status = VENDOR_STATUS_OK;
+
+  if (vendor_req_pending != 0U)
+  {
+    switch (vendor_req_cmd)
+    {
+      case VENDOR_CMD_PING:
+        len = vendor_req_len;
+        memcpy(reply, vendor_req_buf, len);
+        break;
+
+      case VENDOR_CMD_GET_STATS:
+        len = VENDOR_GetStats(reply);
+        break;
+
+      case VENDOR_CMD_GET_FAULT:
+        record = Fault_GetRecord();
+        if (record != NULL)
+        {
+          len = sizeof(Fault_RecordTypeDef);
+          memcpy(reply, record, len);
+        }
+        else
+        {
+          status = VENDOR_STATUS_NO_DATA;
+        }
+        break;
+
+      case VENDOR_CMD_STREAM:
+        if (vendor_req_len != 2U)
+        {
+          status = VENDOR_STATUS_BAD_LENGTH;
+          break;
+        }
+        period = (uint16_t)(vendor_req_buf[0] | ((uint16_t)vendor_req_buf[1] << 8));
+        if ((period != 0U) && (period < VENDOR_STREAM_MIN_MS))
+        {
+          period = VENDOR_STREAM_MIN_MS;
+        }
+        __disable_irq();
+        vendor_stream_count = period;
+        vendor_stream_period = period;
+        vendor_stream_due = 0U;
+        __enable_irq();
+        reply[0] = LOBYTE(period);
+        reply[1] = HIBYTE(period);
+        len = 2U;
+        break;
+
+      default:
+        status = VENDOR_STATUS_UNKNOWN;
+        break;
+    }
+
+    if (USBD_VENDOR_SendFrame(&hUsbDeviceFS, vendor_req_cmd | VENDOR_FRAME_REPLY,
+                              vendor_req_seq, status, reply, len) != USBD_BUSY)
+    {
+      vendor_req_pending = 0U;
+    }
+  }
+
+  if (vendor_stream_due != 0U)
+  {
+    len = VENDOR_GetStats(reply);
+    if (USBD_VENDOR_SendFrame(&hUsbDeviceFS, VENDOR_CMD_STREAM | VENDOR_FRAME_REPLY,
+                              vendor_stream_seq, VENDOR_STATUS_OK, reply, len) != USBD_BUSY)
+    {
+      vendor_stream_seq++;
+      vendor_stream_due = 0U;
+    }
+  }
+}
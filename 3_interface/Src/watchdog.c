@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file           : watchdog.c
+  * @brief          : Independent watchdog supervisor.
+  *
+  *                   Each subsystem sets its liveness token while it runs.
+  *                   A token is armed by its first check-in and can be
+  *                   disarmed while the subsystem is legitimately quiet
+  *                   (USB suspend). Every WDG_CHECK_MS the SysTick hook
+  *                   refreshes the IWDG if all armed tokens are set and
+  *                   clears them. Otherwise the missing tokens are written
+  *                   to backup register DR1 and the IWDG resets the chip.
+  *                   The record survives the reset and is read back by
+  *                   Watchdog_Init.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "watchdog.h"
+
+/* Private define ------------------------------------------------------------*/
+/* DR1 layout: tag in the high byte, missing tokens / cause in the low byte */
+#define WDG_BKP_TAG                      0xA500U
+#define WDG_BKP_TAG_MASK                 0xFF00U
+#define WDG_BKP_CAUSE_MASK               0x00FFU
+
+/* Private variables ---------------------------------------------------------*/
+static IWDG_HandleTypeDef *wdg_handle;
+
+static volatile uint32_t wdg_tokens;
+static volatile uint32_t wdg_armed;
+static uint32_t wdg_elapsed;
+static uint8_t  wdg_recorded;
+static uint32_t wdg_reset_cause;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Watchdog_Record(uint32_t cause);
+
+/* Private user code ---------------------------------------------------------*/
+
+/**
+  * @brief  Take over the refresh of a started IWDG and read back the cause
+  *         of a previous watchdog reset.
+  * @param  hiwdg: initialized IWDG handle
+  * @retval None
+  */
+void Watchdog_Init(IWDG_HandleTypeDef *hiwdg)
+{
+  uint32_t record;
+
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+
+  record = BKP->DR1;
+  if (((record & WDG_BKP_TAG_MASK) == WDG_BKP_TAG) &&
+      ((__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) != RESET) ||
+       (__HAL_RCC_GET_FLAG(RCC_FLAG_SFTRST) != RESET)))
+  {
+    wdg_reset_cause = record & WDG_BKP_CAUSE_MASK;
+  }
+  BKP->DR1 = 0U;
+  __HAL_RCC_CLEAR_RESET_FLAGS();
+
+  wdg_armed = WDG_TOKEN_MAIN;
+  wdg_handle = hiwdg;
+}
+
+/**
+  * @brief  Report a subsystem alive, arms its token. Interrupt safe.
+  * @param  token: WDG_TOKEN_xxx
+  * @retval None
+  */
+void Watchdog_CheckIn(uint32_t token)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  wdg_tokens |= token;
+  wdg_armed |= token;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Stop supervising a subsystem until its next check-in.
+  * @param  token: WDG_TOKEN_xxx
+  * @retval None
+  */
+void Watchdog_Disarm(uint32_t token)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  wdg_armed &= ~token;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  1 ms tick, checks the tokens every WDG_CHECK_MS.
+  * @retval None
+  */
+void Watchdog_Tick(void)
+{
+  uint32_t missing;
+
+  if (wdg_handle == NULL)
+  {
+    return;
+  }
+
+  if (++wdg_elapsed < WDG_CHECK_MS)
+  {
+    return;
+  }
+  wdg_elapsed = 0U;
+
+  missing = wdg_armed & ~wdg_tokens;
+  if (missing == 0U)
+  {
+    HAL_IWDG_Refresh(wdg_handle);
+    wdg_tokens = 0U;
+    if (wdg_recorded != 0U)
+    {
+      /* Late check-in, the reset did not happen */
+      BKP->DR1 = 0U;
+      wdg_recorded = 0U;
+    }
+  }
+  else if (wdg_recorded == 0U)
+  {
+    Watchdog_Record(missing);
+  }
+}
+
+/**
+  * @brief  Record a cause and reset: wait for the IWDG when it runs,
+  *         otherwise reset right away.
+  * @param  cause: WDG_CAUSE_xxx
+  * @retval None
+  */
+void Watchdog_Panic(uint32_t cause)
+{
+  __disable_irq();
+
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+  Watchdog_Record(cause);
+
+  if (wdg_handle == NULL)
+  {
+    NVIC_SystemReset();
+  }
+
+  while (1)
+  {
+  }
+}
+
+/**
+  * @brief  Cause recorded before the last watchdog or software reset.
+  * @retval missing WDG_TOKEN_xxx or WDG_CAUSE_xxx, 0 if none
+  */
+uint32_t Watchdog_GetResetCause(void)
+{
+  return wdg_reset_cause;
+}
+
+/**
+  * @brief  Write a cause to the backup register.
+  * @param  cause: missing tokens or WDG_CAUSE_xxx
+  * @retval None
+  */
+static void Watchdog_Record(uint32_t cause)
+{
+  BKP->DR1 = WDG_BKP_TAG | (cause & WDG_BKP_CAUSE_MASK);
+  wdg_recorded = 1U;
+}